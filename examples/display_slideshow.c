@@ -15,9 +15,16 @@
 #include "pandatouch_display.h"
 #include "pandatouch_msc.h"
 #include "pandatouch_lvgl_msc.h"
+#include "pandatouch_image_cache.h"
 
 static const char *TAG = "PandaTouch_display_slideshow";
 
+// Coalescing key for the main image area: only the newest pending image/placeholder update runs
+#define UI_KEY_CONTENT 1
+
+// Images decoded ahead of the one on screen (see pandatouch_image_cache.h)
+#define PREFETCH_AHEAD 2
+
 // UI objects (owned by LVGL thread)
 static lv_obj_t *s_img = NULL;
 static lv_obj_t *s_status_lbl = NULL;
@@ -39,19 +46,19 @@ static void scan_usb_for_pngs(void);
 static void usb_on_mount(void);
 static void usb_on_unmount(void);
 
-// Recursively scan path using pt_usb_list_dir and collect *.png/*.PNG
+// Recursively scan path using pt_usb_list_dir_ex and collect *.png/*.PNG (names only, no per-file stat)
 static void scan_dir_recursive(const char *path, char ***out_arr, size_t *out_cnt)
 {
     ESP_LOGI(TAG, "scan_dir_recursive: %s", path ? path : "(null)");
     int err = 0;
-    pt_usb_dir_list_t *list = pt_usb_list_dir(path, &err);
+    pt_usb_dir_list_t *list = pt_usb_list_dir_ex(path, 0, &err);
     if (!list)
     {
-        ESP_LOGW(TAG, "pt_usb_list_dir(\"%s\") returned NULL, err=%d", path ? path : "(null)", err);
+        ESP_LOGW(TAG, "pt_usb_list_dir_ex(\"%s\") returned NULL, err=%d", path ? path : "(null)", err);
         return;
     }
 
-    ESP_LOGI(TAG, "pt_usb_list_dir: %s -> %zu entries", path, list->count);
+    ESP_LOGI(TAG, "pt_usb_list_dir_ex: %s -> %zu entries", path, list->count);
     for (size_t i = 0; i < list->count; ++i)
     {
         pt_usb_dir_entry_t *e = &list->entries[i];
@@ -144,8 +151,10 @@ static void usb_on_unmount(void)
     s_images = NULL;
     s_images_count = 0;
     s_have_images = false;
+    // decoded images of the old stick are of no use any more
+    pt_image_cache_clear();
     // update UI
-    pt_display_schedule_ui((pt_ui_fn_t)ui_show_placeholder, NULL);
+    pt_display_post_ui((pt_ui_fn_t)ui_show_placeholder, NULL, UI_KEY_CONTENT);
 }
 
 static void scan_usb_for_pngs(void)
@@ -166,7 +175,7 @@ static void scan_usb_for_pngs(void)
     if (s_have_images)
     {
         ESP_LOGI(TAG, "Scheduling immediate display of first image: %s", s_images[0]);
-        pt_display_schedule_ui(ui_set_image_arg, (void *)s_images[0]);
+        pt_display_post_ui(ui_set_image_arg, (void *)s_images[0], UI_KEY_CONTENT);
     }
 }
 
@@ -345,16 +354,24 @@ static void start_slideshow_task(void *arg)
                 fclose(f);
             }
 
-            pt_display_schedule_ui(ui_set_image_arg, (void *)image);
+            pt_display_post_ui(ui_set_image_arg, (void *)image, UI_KEY_CONTENT);
 
             // advance
             idx = (idx + 1) % s_images_count;
+
+            // decode the next images on core 0 while this one is shown, so the next
+            // lv_img_set_src() finds them ready instead of stalling the LVGL thread
+            const char *next[PREFETCH_AHEAD];
+            size_t n = 0;
+            for (; n < PREFETCH_AHEAD && n + 1 < s_images_count; n++)
+                next[n] = s_images[(idx + n) % s_images_count];
+            pt_image_cache_prefetch(next, n);
             vTaskDelay(pdMS_TO_TICKS(5000));
         }
         else
         {
             // no images: update UI placeholder occasionally
-            pt_display_schedule_ui((pt_ui_fn_t)ui_show_placeholder, NULL);
+            pt_display_post_ui((pt_ui_fn_t)ui_show_placeholder, NULL, UI_KEY_CONTENT);
             vTaskDelay(pdMS_TO_TICKS(1000));
         }
     }
@@ -370,6 +387,12 @@ void app_main(void)
         return;
     }
 
+    // Decoded-image cache (budget from PT_IMAGE_CACHE_KB)
+    if (pt_image_cache_init(0) != ESP_OK)
+    {
+        ESP_LOGW(TAG, "image cache unavailable, images are decoded on the LVGL thread");
+    }
+
     // Register USB callbacks and start host
     pt_usb_on_mount(usb_on_mount);
     pt_usb_on_unmount(usb_on_unmount);
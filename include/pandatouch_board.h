@@ -55,6 +55,10 @@
 
 #define PT_GT911_REG_STATUS 0x814E
 #define PT_GT911_REG_POINT1 0x814F
+#define PT_GT911_REG_CONFIG 0x8047       // config block 0x8047..0x80FE
+#define PT_GT911_CONFIG_LEN 184
+#define PT_GT911_REG_CONFIG_CHKSUM 0x80FF
+#define PT_GT911_REG_CONFIG_FRESH 0x8100
 #define PT_GT911_MAX_POINTS 5
 #define PT_GT911_I2C_SCL_GPIO 1
 #define PT_GT911_I2C_SDA_GPIO 2
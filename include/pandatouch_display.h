@@ -5,6 +5,7 @@ extern "C"
 #endif
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include "esp_err.h"
 #include "lvgl.h"
@@ -18,29 +19,133 @@ extern "C"
         PT_LVGL_RENDER_PARTIAL_1,
         PT_LVGL_RENDER_PARTIAL_2, /* default */
         PT_LVGL_RENDER_PARTIAL_1_PSRAM,
-        PT_LVGL_RENDER_PARTIAL_2_PSRAM
+        PT_LVGL_RENDER_PARTIAL_2_PSRAM,
+        PT_LVGL_RENDER_DIRECT_2
     } PT_LVGL_render_method_t;
 
+    /* ======= Render buffers actually in use ======= */
+    typedef struct
+    {
+        PT_LVGL_render_method_t method;
+        uint32_t buf_bytes;     /* size of each render buffer */
+        uint8_t buf_count;      /* 1 or 2 */
+        uint16_t partial_lines; /* lines per partial buffer (0 for FULL/DIRECT methods) */
+        bool in_psram;          /* buffers ended up in PSRAM (after the internal/PSRAM fallback) */
+    } pt_display_buffer_info_t;
+
+    /* ======= Flush coalescing counters (since boot) ======= */
+    typedef struct
+    {
+        uint32_t areas_in;      /* areas invalidated by LVGL */
+        uint32_t areas_merged;  /* areas absorbed into another one or widened to full width */
+        uint32_t transfers_out; /* flush callbacks, i.e. transfers to the panel */
+    } pt_display_coalesce_stats_t;
+
+    /* ======= UI command queue counters (since boot) ======= */
+    typedef struct
+    {
+        uint32_t posted;         /* callbacks accepted into the queue */
+        uint32_t executed;       /* callbacks run on the LVGL task */
+        uint32_t coalesced;      /* callbacks dropped because a newer post with the same key was pending */
+        uint32_t pool_exhausted; /* posts that found no free node (task posts then use lv_async_call) */
+        uint16_t pool_size;      /* PT_DISPLAY_UI_QUEUE_SIZE */
+    } pt_display_ui_queue_stats_t;
+
+    /* ======= Frame pipeline statistics (one measurement window) ======= */
+    typedef struct
+    {
+        uint32_t window_ms;         /* length of the window these numbers cover */
+        uint32_t frames;            /* completed LVGL refreshes */
+        uint64_t render_time_us;    /* time between LVGL render start and end, summed */
+        uint64_t flush_time_us;     /* time spent copying to the panel, summed */
+        uint32_t flush_count;       /* flush callbacks */
+        uint64_t bytes_pushed;      /* pixel bytes handed to the panel */
+        uint32_t lock_max_hold_us;  /* longest pt_lvgl_lock() hold */
+        uint32_t stack_hwm_bytes;   /* LVGL task stack high-water mark (minimum free bytes) */
+        uint32_t frame_time_p50_us; /* refresh duration percentiles (1 ms resolution) */
+        uint32_t frame_time_p95_us;
+        uint32_t frame_time_p99_us;
+        uint32_t frame_time_max_us;
+        uint32_t input_frames;         /* frames that showed a new input sample */
+        uint32_t input_latency_p50_us; /* input sample -> last flush of the frame showing it (1 ms resolution) */
+        uint32_t input_latency_p95_us;
+        uint32_t input_latency_p99_us;
+        uint32_t input_latency_max_us;
+        uint32_t vsync_timeouts; /* DIRECT_2 buffer swaps not confirmed by a VSYNC within 100 ms */
+    } pt_display_stats_t;
+
+    /* ======= pt_lvgl_lock() profile, one entry per caller ======= */
+    typedef struct
+    {
+        char task_name[16];     /* task that took the lock ("(other)" once the table is full) */
+        const void *caller;     /* return address of the pt_lvgl_lock() call (NULL for "(other)") */
+        uint32_t count;         /* outermost acquisitions */
+        uint64_t wait_total_us; /* time blocked waiting for the lock */
+        uint32_t wait_max_us;
+        uint64_t hold_total_us; /* time between acquisition and the matching outermost unlock */
+        uint32_t hold_max_us;
+    } pt_lvgl_lock_profile_entry_t;
+
     /* ======= Lifecycle ======= */
     esp_err_t pt_display_init(void);
     bool pt_backlight_set(uint32_t percent);
     uint32_t pt_backlight_get(void);
 
     /* ======= LVGL helpers ======= */
-    /* Schedule a function to run on the LVGL thread (lv_async_call) */
+    /* Schedule a function to run on the LVGL thread (before the next render, no allocation) */
     typedef void (*pt_ui_fn_t)(void *arg);
     void pt_display_schedule_ui(pt_ui_fn_t fn, void *arg);
 
+    /* Same, with a coalescing key: if several posts with the same non-zero key are pending,
+       only the newest one runs (older ones are dropped, their `arg` is not touched).
+       key 0 disables coalescing. Returns false if the callback could not be queued. */
+    bool pt_display_post_ui(pt_ui_fn_t fn, void *arg, uint32_t key);
+    /* ISR-safe variant: never blocks or allocates, returns false when the pool is exhausted */
+    bool pt_display_post_ui_from_isr(pt_ui_fn_t fn, void *arg, uint32_t key);
+    void pt_display_get_ui_queue_stats(pt_display_ui_queue_stats_t *out);
+
+    /* Switch render method and buffers at runtime (pauses rendering while buffers are swapped).
+       partial_lines <= 0 uses PT_LVGL_RENDER_PARTIAL_BUFFER_LINES. On ESP_ERR_NO_MEM the previous
+       buffers stay in use; ESP_ERR_TIMEOUT if an asynchronous flush does not finish. `out_info`
+       (optional) reports what was actually allocated. */
+    esp_err_t pt_display_set_render_method(PT_LVGL_render_method_t method, int partial_lines, pt_display_buffer_info_t *out_info);
+    void pt_display_get_buffer_info(pt_display_buffer_info_t *out);
+
+    /* Read the flush coalescing counters */
+    void pt_display_get_coalesce_stats(pt_display_coalesce_stats_t *out);
+
+    /* Snapshot the current statistics window; `reset` starts a new one.
+       Returns ESP_ERR_NOT_SUPPORTED when PT_DISPLAY_STATS is disabled. */
+    esp_err_t pt_display_get_stats(pt_display_stats_t *out, bool reset);
+
+    /* Report an input sample consumed on the LVGL task (esp_timer time it was taken) for the
+       input latency statistics; the touch glue does this, custom input devices may too */
+    void pt_display_note_input(int64_t timestamp_us);
+
+    /* Wake the LVGL task if it sleeps with no timer due (safe from ISRs) */
+    void pt_display_wake(void);
+
     /* Get the created lv_display_t* (after pt_init) */
     lv_display_t *pt_get_display(void);
 
     /* Access the underlying esp_lcd panel if needed */
     esp_lcd_panel_handle_t pt_get_panel(void);
 
+    /* VSYNC pacing (PT_LVGL_TASK_PACING_VSYNC): render every `divisor` panel frames (1..6) */
+    esp_err_t pt_display_set_vsync_divisor(uint8_t divisor);
+    /* Number of render slots that passed without a render since boot (0 with timer pacing) */
+    uint32_t pt_display_get_missed_frames(void);
+
     /* Expose the lock macro so user code can safely touch LVGL from other tasks */
     void pt_lvgl_lock(void);
     void pt_lvgl_unlock(void);
 
+    /* Lock profiler (PT_LVGL_LOCK_PROFILER): copy up to `max` entries, `reset` clears the table.
+       Returns the number of entries copied (0 when the profiler is disabled). */
+    size_t pt_lvgl_lock_profile_get(pt_lvgl_lock_profile_entry_t *out, size_t max, bool reset);
+    /* Log the profile, sorted by total wait time */
+    void pt_lvgl_lock_profile_dump(bool reset);
+
 /* Convenience RAII-ish scope macro */
 #define PT_LVGL_SCOPE_LOCK()              \
     for (int _once = 1; _once; _once = 0) \
@@ -0,0 +1,70 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /*
+     * Decoded-image cache (PT_IMAGE_CACHE).
+     *
+     * PNG files are decoded off the LVGL thread into PSRAM and kept in an LRU within a byte
+     * budget, keyed by path, file size and mtime. The cache registers an LVGL image decoder
+     * that runs before the built-in ones, so lv_image_set_src(img, "/usb/a.png") on a cached
+     * path hands LVGL the decoded pixels without touching the file or the PNG decoder.
+     * Paths are POSIX paths, as used with the '/' stdio driver (pt_lvgl_stdio_fs_init()).
+     */
+
+    typedef struct
+    {
+        uint32_t entries;
+        uint32_t bytes;        /* decoded pixels held */
+        uint32_t budget_bytes;
+        uint32_t hits;         /* lookups by LVGL served from the cache */
+        uint32_t misses;       /* PNG/JPEG lookups by LVGL that fell through to the regular decoders */
+        uint32_t decodes;      /* images decoded into the cache */
+        uint32_t decode_errors;
+        uint32_t evictions;
+        uint32_t prefetch_dropped; /* queued prefetches replaced by a newer pt_image_cache_prefetch() */
+        uint32_t max_decode_us;    /* slowest read + decode */
+        uint32_t assets_loaded;    /* images read from a converted file instead of being decoded */
+        uint32_t assets_written;   /* converted files written to the stick */
+    } pt_image_cache_stats_t;
+
+    /* Register the decoder and start the prefetch worker (pinned to core 0, away from LVGL).
+       budget_bytes 0 uses PT_IMAGE_CACHE_KB. Call after pt_display_init(). */
+    esp_err_t pt_image_cache_init(size_t budget_bytes);
+
+    /* Queue up to `count` paths (in priority order) for decoding on the worker. Replaces any
+       prefetches still pending, so a slideshow can simply pass "the next N" every time it advances.
+       Cached paths are only marked as recently used. */
+    esp_err_t pt_image_cache_prefetch(const char *const *paths, size_t count);
+
+    /* Decode `path` into the cache in the calling task (blocks; do not call from the LVGL task) */
+    esp_err_t pt_image_cache_load(const char *path);
+
+    bool pt_image_cache_contains(const char *path);
+
+    /* Drop every entry; the memory is released on the LVGL thread */
+    void pt_image_cache_clear(void);
+
+    void pt_image_cache_get_stats(pt_image_cache_stats_t *out);
+
+    /* --------- Converted assets on the stick (PT_ASSET_CACHE) --------- */
+
+    /* Convert `src` now in the calling task, unless a valid converted file already exists.
+       ESP_ERR_NOT_SUPPORTED for files that are not PNG/JPEG on the stick. */
+    esp_err_t pt_asset_convert(const char *src);
+    /* Path of the converted file for `src` if there is a valid one (ESP_OK); otherwise `src`
+       itself is copied and ESP_ERR_NOT_FOUND returned. Either way `out` can go to lv_image_set_src(). */
+    esp_err_t pt_asset_resolve(const char *src, char *out, size_t out_len);
+    /* Delete the whole conversion directory */
+    esp_err_t pt_asset_purge(void);
+
+#ifdef __cplusplus
+}
+#endif
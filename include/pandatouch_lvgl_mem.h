@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define PT_LVGL_MEM_MAX_CLASSES 5 /* 16, 32, 64, 128, 256 bytes */
+
+    /* Usage of one slab size class */
+    typedef struct
+    {
+        uint16_t slot_size;       /* bytes per slot */
+        uint32_t slots_total;     /* slots carved from the pages owned by this class */
+        uint32_t slots_used;      /* slots currently allocated */
+        uint32_t bytes_requested; /* sum of the sizes requested for the used slots */
+        uint32_t allocs;          /* allocations served since boot */
+        uint32_t spills;          /* requests sent to PSRAM because the class and the arena were full */
+    } pt_lvgl_mem_class_stats_t;
+
+    /* Tiered LVGL allocator statistics (PT_LVGL_MEM_TIERED) */
+    typedef struct
+    {
+        /* Small tier: internal-RAM slab arena */
+        uint32_t arena_bytes;       /* 0 if the arena could not be allocated (or the option is off) */
+        uint16_t arena_pages_used;  /* 1 kB pages handed to a size class */
+        uint16_t arena_pages_total;
+        uint32_t small_internal_frag_bytes; /* rounding waste in used slots (slot size - requested) */
+        uint32_t small_free_slot_bytes;     /* free slots stranded in pages owned by a class */
+        uint8_t class_count;
+        pt_lvgl_mem_class_stats_t classes[PT_LVGL_MEM_MAX_CLASSES];
+
+        /* Large tier: heap, PSRAM preferred */
+        uint32_t large_blocks;            /* live blocks */
+        uint32_t large_bytes;             /* bytes held by live blocks (as reported by the heap) */
+        uint32_t large_allocs;            /* allocations since boot */
+        uint32_t large_internal_fallbacks; /* allocations that landed in internal RAM because PSRAM was full */
+        uint32_t psram_free_bytes;         /* free PSRAM heap */
+        uint32_t psram_largest_free_block; /* largest allocatable PSRAM block (fragmentation indicator) */
+    } pt_lvgl_mem_stats_t;
+
+    /**
+     * Snapshot the LVGL allocator statistics.
+     *
+     * Only available when PT_LVGL_USE_PT_INTERNAL_MALLOC is enabled; the small-tier
+     * fields stay zero unless PT_LVGL_MEM_TIERED is enabled too.
+     * Returns false if the component does not provide the LVGL allocator.
+     */
+    bool pt_lvgl_mem_get_stats(pt_lvgl_mem_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
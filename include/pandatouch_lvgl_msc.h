@@ -1,6 +1,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "lvgl.h"
 
 #ifdef __cplusplus
@@ -8,6 +9,20 @@ extern "C"
 {
 #endif
 
+    /* Block cache counters (CONFIG_PT_LVGL_FS_CACHE); all zero when the cache is off */
+    typedef struct
+    {
+        uint32_t hits;             /* block lookups served from PSRAM */
+        uint32_t misses;           /* USB transfers made to fill a missing block */
+        uint32_t readahead_blocks; /* extra blocks fetched by those transfers */
+        uint32_t bypass_reads;     /* reads larger than a readahead run, passed straight to the file */
+        uint32_t evictions;
+        uint32_t invalidations;
+        uint64_t disk_bytes; /* bytes read from the stick through the driver */
+        uint32_t blocks;     /* capacity in blocks; 0 if the cache could not be allocated */
+        uint32_t block_size;
+    } pt_lvgl_fs_cache_stats_t;
+
     /**
      * Initialize an LVGL filesystem driver that uses standard C stdio/DIR
      * functions to access POSIX-style paths (supports absolute paths like "/usb/...").
@@ -16,6 +31,15 @@ extern "C"
      */
     void pt_lvgl_stdio_fs_init(void);
 
+    /**
+     * Drop every cached block. Called by pt_usb when the stick is unmounted; call it yourself
+     * after rewriting a file outside LVGL if its size and modification time may be unchanged.
+     * Safe from any task.
+     */
+    void pt_lvgl_stdio_fs_cache_invalidate(void);
+
+    void pt_lvgl_stdio_fs_cache_get_stats(pt_lvgl_fs_cache_stats_t *out);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,7 +1,31 @@
 
 #pragma once
+#include "esp_err.h"
 #include "lvgl.h"
 
+/**
+ * Raw controller -> display transform in Q16.16 fixed point:
+ *   x' = (a*x + b*y + c) >> 16,  y' = (d*x + e*y + f) >> 16
+ * The result is in the panel's native (unrotated) orientation; LVGL applies display rotation.
+ */
+typedef struct
+{
+    int32_t a, b, c;
+    int32_t d, e, f;
+} pt_lvgl_touch_matrix_t;
+
+/* How the touch sensor is mounted relative to the panel (flags, applied when not calibrated) */
+#define PT_LVGL_TOUCH_ORIENT_SWAP_XY 0x01
+#define PT_LVGL_TOUCH_ORIENT_INVERT_X 0x02
+#define PT_LVGL_TOUCH_ORIENT_INVERT_Y 0x04
+
+/* One calibration sample: where the controller reported a touch and where the target was drawn */
+typedef struct
+{
+    int raw_x, raw_y; /* from pt_lvgl_touch_get_raw() */
+    int scr_x, scr_y; /* target in LVGL screen coordinates (current rotation) */
+} pt_lvgl_touch_cal_point_t;
+
 /**
  * Create and register an LVGL pointer input device backed by PT_GT911.
  *
@@ -13,3 +37,74 @@
  */
 lv_indev_t *pt_lvgl_touch_init(lv_display_t *disp,
                                int tp_w, int tp_h);
+
+/**
+ * Service a pending touch interrupt by reading the input device once.
+ * Called by the LVGL task with the LVGL lock held; no-op when nothing is pending.
+ */
+void pt_lvgl_touch_process(void);
+
+/**
+ * Frame-synchronised input (PT_LVGL_TOUCH_FRAME_SYNC): called by the display driver when a refresh
+ * starts, before layout and rendering, so the frame shows the newest sample. Drains a pending
+ * interrupt in event mode, samples the controller when polling.
+ */
+void pt_lvgl_touch_frame_sync(void);
+
+/**
+ * Jitter filter applied to mapped points before LVGL sees them (PT_LVGL_TOUCH_FILTER).
+ * Stages run in this order; each has its own enable flag.
+ */
+typedef struct
+{
+    bool debounce_en;      /* press/release debounce */
+    uint8_t press_frames;  /* consecutive touched frames before a press is reported (>= 1) */
+    uint16_t release_ms;   /* a lift is reported only if no touch follows within this time */
+    bool ema_en;           /* exponential moving average */
+    uint16_t ema_alpha_q8; /* weight of the newest sample, 1..256 (256 = no smoothing) */
+    bool deadband_en;      /* ignore small moves around the last reported point */
+    uint8_t deadband_px;   /* per-axis radius in display pixels */
+} pt_lvgl_touch_filter_t;
+
+/**
+ * Replace the filter settings (takes the LVGL lock). Filter state is reset.
+ * @return ESP_ERR_INVALID_ARG for out-of-range values, ESP_ERR_NOT_SUPPORTED without PT_LVGL_TOUCH_FILTER.
+ */
+esp_err_t pt_lvgl_touch_set_filter(const pt_lvgl_touch_filter_t *cfg);
+
+/** Read the current filter settings (Kconfig defaults until pt_lvgl_touch_set_filter()). */
+void pt_lvgl_touch_get_filter(pt_lvgl_touch_filter_t *out);
+
+/**
+ * Set the drag prediction horizon (PT_LVGL_TOUCH_PREDICT): how far ahead of the LVGL read, in ms,
+ * the reported point should be. 0 turns prediction off.
+ * @return ESP_ERR_INVALID_ARG above 100 ms, ESP_ERR_NOT_SUPPORTED without PT_LVGL_TOUCH_PREDICT.
+ */
+esp_err_t pt_lvgl_touch_set_predict_ms(uint16_t horizon_ms);
+
+/** Current prediction horizon in ms (0 when prediction is off or compiled out). */
+uint16_t pt_lvgl_touch_get_predict_ms(void);
+
+/** Set the sensor mounting flags (PT_LVGL_TOUCH_ORIENT_*); rebuilds the default transform. */
+esp_err_t pt_lvgl_touch_set_orientation(uint8_t flags);
+uint8_t pt_lvgl_touch_get_orientation(void);
+
+/** Last raw controller point of the pointer; returns true while it is pressed. */
+bool pt_lvgl_touch_get_raw(int *x, int *y);
+
+/**
+ * Least-squares fit of a transform to n >= 3 non-collinear samples (5 or more recommended).
+ * Does not apply it: pass `out` to pt_lvgl_touch_set_matrix(). `max_err_px` (optional) receives
+ * the worst residual in display pixels.
+ */
+esp_err_t pt_lvgl_touch_calibrate(const pt_lvgl_touch_cal_point_t *pts, size_t n,
+                                  pt_lvgl_touch_matrix_t *out, float *max_err_px);
+
+/** Use `m` for mapping (NULL returns to scale + orientation). Takes the LVGL lock. */
+esp_err_t pt_lvgl_touch_set_matrix(const pt_lvgl_touch_matrix_t *m);
+void pt_lvgl_touch_get_matrix(pt_lvgl_touch_matrix_t *out);
+
+/** Persist the current calibration in NVS (PT_LVGL_TOUCH_CAL_NVS); it is loaded by pt_lvgl_touch_init(). */
+esp_err_t pt_lvgl_touch_save_calibration(void);
+/** Drop the calibration, in RAM and in NVS. */
+esp_err_t pt_lvgl_touch_erase_calibration(void);
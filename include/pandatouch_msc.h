@@ -23,6 +23,24 @@
 #define PT_USB_INSTALL_RETRY_DELAY_MS 500
 #endif
 
+// streaming file handles (pt_usb_open)
+#ifndef PT_USB_FILE_BUF_DEFAULT
+#define PT_USB_FILE_BUF_DEFAULT (32 * 1024) /* stdio buffer per handle when buf_size is 0 */
+#endif
+#ifndef PT_USB_FILE_BUF_ALIGN
+#define PT_USB_FILE_BUF_ALIGN 64 /* cache line (PSRAM) and DMA friendly */
+#endif
+
+/* pt_usb_open() flags */
+#define PT_USB_O_READ 0x01
+#define PT_USB_O_WRITE 0x02
+#define PT_USB_O_CREATE 0x04 /* create the file (and parent directories) if missing */
+#define PT_USB_O_TRUNC 0x08  /* truncate to 0 bytes; implies CREATE */
+#define PT_USB_O_APPEND 0x10 /* every write goes to the end of the file; implies CREATE */
+
+/* pt_usb_list_dir_ex() flags */
+#define PT_USB_LIST_SIZES 0x01 /* stat every file up front so `size` is filled in */
+
 typedef enum
 {
     PT_USB_STATE_STOPPED = 0,
@@ -43,16 +61,21 @@ typedef struct
     char *path;     /* full absolute path */
     bool is_dir;    /* true if entry is a directory */
     bool is_hidden; /* true if filename is hidden (starts with '.') */
+    bool has_size;  /* `size` is valid (always for directories; see PT_USB_LIST_SIZES) */
     size_t size;    /* file size in bytes (0 for directories or unknown) */
 } pt_usb_dir_entry_t;
 
-/* Object returned by new list API: owns the entries array; free with pt_usb_dir_list_free(). */
+/* Object returned by new list API: one allocation holding the entries array and all name/path
+   strings; free with pt_usb_dir_list_free(). */
 typedef struct pt_usb_dir_list
 {
     pt_usb_dir_entry_t *entries;
     size_t count;
 } pt_usb_dir_list_t;
 
+/* Open file handle; opaque, see pt_usb_open() */
+typedef struct pt_usb_file pt_usb_file_t;
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -65,13 +88,30 @@ extern "C"
     bool pt_usb_is_mounted(void);
     bool pt_usb_get_info(pt_usb_info_t *out);
 
+    /* Same as pt_usb_list_dir_ex(path, PT_USB_LIST_SIZES, out_err) */
     pt_usb_dir_list_t *pt_usb_list_dir(const char *path, int *out_err);
+    /* Without PT_USB_LIST_SIZES only the directory itself is read: the file type comes from readdir()
+       and sizes are left for pt_usb_dir_entry_size() */
+    pt_usb_dir_list_t *pt_usb_list_dir_ex(const char *path, uint32_t flags, int *out_err);
+    /* Size of a listed file, stat'ed on first use and stored in the entry */
+    int pt_usb_dir_entry_size(pt_usb_dir_entry_t *ent, size_t *out_size);
     void pt_usb_dir_list_free(pt_usb_dir_list_t *list);
     int pt_usb_mkdir(const char *path);
     int pt_usb_rmdir(const char *path, bool recursive);
     int pt_usb_write(const char *path, const void *data, size_t len, bool append);
     int pt_usb_read(const char *path, void *buf, size_t buf_size, size_t *out_len);
     int pt_usb_remove(const char *path);
+
+    /* Streaming file API. A handle owns a stdio buffer of `buf_size` bytes (0: PT_USB_FILE_BUF_DEFAULT,
+       rounded up to 512) allocated with `buf_caps` (0: internal DMA-capable RAM, PSRAM as fallback).
+       Offsets are absolute; sequential calls reuse the buffer without seeking. A handle may only be
+       used by one task at a time and becomes invalid (-ENODEV) once the stick is unmounted. */
+    int pt_usb_open(const char *path, uint32_t flags, size_t buf_size, uint32_t buf_caps, pt_usb_file_t **out);
+    int pt_usb_pread(pt_usb_file_t *f, void *buf, size_t len, uint64_t offset, size_t *out_len);
+    int pt_usb_pwrite(pt_usb_file_t *f, const void *buf, size_t len, uint64_t offset, size_t *out_len);
+    int pt_usb_size(pt_usb_file_t *f, uint64_t *out_size);
+    int pt_usb_close(pt_usb_file_t *f);
+
     void pt_usb_on_mount(PandaTouchEventCallback cb);
     void pt_usb_on_unmount(PandaTouchEventCallback cb);
 
@@ -18,9 +18,105 @@ typedef struct
 {
     uint8_t number; // 0..5
     pt_touch_point_t point[PT_GT911_MAX_POINTS];
+    int64_t timestamp_us; // esp_timer time of the INT edge (sampling task) or of the read (polling)
 } pt_touch_event_t;
 
+/* Log2 latency histogram: bucket 0 counts 0 us, bucket i counts [2^(i-1), 2^i) us,
+   the last bucket everything from 2^(PT_TOUCH_LAT_BUCKETS-2) us (~16 ms) up */
+#define PT_TOUCH_LAT_BUCKETS 16
+
+typedef struct
+{
+    uint32_t count;
+    uint64_t total_us;
+    uint32_t max_us;
+    uint32_t hist[PT_TOUCH_LAT_BUCKETS];
+} pt_touch_latency_t;
+
+typedef struct
+{
+    uint32_t window_ms; // length of the window these numbers cover
+
+    /* I2C traffic of the touch driver */
+    uint32_t i2c_transactions;       // bus transactions (a STOP+read fallback counts as two)
+    uint64_t i2c_bytes;              // bytes on the bus, register address included
+    uint32_t i2c_transactions_per_s; // over the window
+    uint32_t i2c_bytes_per_s;
+    uint32_t i2c_fallbacks; // repeated-start reads that had to be retried as STOP + read
+    uint32_t i2c_errors;    // failed transactions
+
+    /* Frames */
+    uint32_t frames;         // fresh frames read (STATUS bit 7 set)
+    uint32_t empty_reads;    // reads that found no new frame
+    uint32_t events_dropped; // frames dropped because the sampling task's queue was full
+
+    /* LVGL side */
+    uint32_t lvgl_reads;        // LVGL read callbacks
+    uint32_t lvgl_delivered;    // read callbacks that delivered a fresh frame
+    uint32_t lvgl_transactions; // I2C transactions issued from the LVGL task
+
+    /* Latencies */
+    pt_touch_latency_t frame_read;     // duration of one frame read (pt_touch_get_touch / sampling task)
+    pt_touch_latency_t int_to_read;    // INT edge -> frame read (sampling task only)
+    pt_touch_latency_t int_to_deliver; // INT edge, or the poll that saw the frame -> lv_indev_data_t filled
+} pt_touch_stats_t;
+
+/* Tunable part of the GT911 configuration block */
+typedef struct
+{
+    uint8_t version;       // Config_Version (0x8047), read-only here
+    uint16_t x_max;        // X output max (0x8048)
+    uint16_t y_max;        // Y output max (0x804A)
+    uint8_t touch_number;  // max touch points, 1..5 (0x804C)
+    uint8_t module_switch1; // INT trigger (bits 0-1), X2Y (bit 3), ... (0x804D)
+    uint8_t touch_level;   // Screen_Touch_Level, press threshold (0x8053)
+    uint8_t leave_level;   // Screen_Leave_Level, release threshold (0x8054)
+    uint8_t refresh_rate;  // report period 5 + N ms, 0..15 (0x8056)
+} pt_touch_gt911_config_t;
+
+/* Error handling and recovery counters (since boot) */
+typedef struct
+{
+    bool recovering;             // reads are suspended while the bus/controller is being recovered
+    uint32_t consecutive_errors; // failed frame reads in a row
+    uint32_t errors;             // failed frame reads
+    uint32_t timeouts;           // I2C transactions that hit PT_TOUCH_I2C_TIMEOUT_MS
+    uint32_t bus_resets;         // i2c_master_bus_reset() calls
+    uint32_t reinits;            // GT911 resets through the address-select sequence
+    uint32_t recovery_failures;  // recovery attempts that did not bring the controller back
+    uint32_t backoff_ms;         // current delay between recovery attempts
+} pt_touch_health_t;
+
+/* Called from the GPIO ISR on every edge of the GT911 INT line */
+typedef void (*pt_touch_int_cb_t)(void *arg);
+
+/* Called from the touch sampling task after a frame was queued */
+typedef void (*pt_touch_event_cb_t)(void *arg);
+
 /* --------- API --------- */
 esp_err_t pt_touch_begin(void);
 bool pt_touch_i2c_ready(void);
+/* true for every fresh frame, including lift frames (ev->number == 0): check number for a press */
 bool pt_touch_get_touch(pt_touch_event_t *ev);
+esp_err_t pt_touch_set_int_cb(pt_touch_int_cb_t cb, void *arg);
+
+void pt_touch_get_health(pt_touch_health_t *out);
+
+/* --------- GT911 configuration --------- */
+/* Read the config block (cached after the first successful read), ESP_ERR_INVALID_CRC on a bad checksum */
+esp_err_t pt_touch_config_read(pt_touch_gt911_config_t *out);
+/* Apply `cfg` to the cached block and write it back (with checksum) only if something changed */
+esp_err_t pt_touch_config_write(const pt_touch_gt911_config_t *cfg);
+
+/* --------- INT-driven sampling task --------- */
+esp_err_t pt_touch_start_task(pt_touch_event_cb_t cb, void *arg);
+bool pt_touch_pop_event(pt_touch_event_t *ev);
+size_t pt_touch_pending_events(void);
+
+/* --------- Statistics (PT_TOUCH_STATS) --------- */
+/* Snapshot the current window; `reset` starts a new one. ESP_ERR_NOT_SUPPORTED when disabled. */
+esp_err_t pt_touch_get_stats(pt_touch_stats_t *out, bool reset);
+/* Upper bound of the `pct` percentile of a histogram, in microseconds */
+uint32_t pt_touch_latency_percentile_us(const pt_touch_latency_t *lat, uint32_t pct);
+/* For input glue: one read callback ran; `ev` is the frame it delivered (NULL if none) */
+void pt_touch_stats_note_read(const pt_touch_event_t *ev);
@@ -0,0 +1,72 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "pandatouch_touch.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*
+ * Touch trace file ("PTTR"), little-endian:
+ *   header:  "PTTR" | u8 version (1) | u8 max points | u16 reserved (0)
+ *   frame:   u32 microseconds since the previous frame | u8 point count
+ *            | count x { u8 track_id | u16 x | u16 y | u16 size }
+ * Coordinates are raw controller coordinates, exactly as pt_touch_get_touch() returns them.
+ */
+#define PT_TOUCH_TRACE_MAGIC "PTTR"
+#define PT_TOUCH_TRACE_VERSION 1
+
+    typedef enum
+    {
+        PT_TOUCH_REPLAY_REALTIME = 0, /* deliver frames with their recorded spacing */
+        PT_TOUCH_REPLAY_FAST,         /* one frame per input device read, no waiting */
+    } pt_touch_replay_mode_t;
+
+    typedef struct
+    {
+        bool recording;
+        bool replaying;
+        uint32_t frames_recorded; /* frames written (or buffered) since pt_touch_record_start() */
+        uint32_t frames_dropped;  /* recorder buffers were full while the USB write was in flight */
+        uint32_t frames_replayed; /* frames delivered since pt_touch_replay_start() */
+        uint32_t frames_total;    /* frames in the trace being replayed */
+        uint32_t max_lag_us;      /* realtime replay: worst delay between a frame's due time and its delivery */
+    } pt_touch_replay_status_t;
+
+    /* --------- Recording (ESP-IDF only; writes through pt_usb_write()) --------- */
+
+    /* Start recording frames delivered by the live controller to `path` on the USB stick
+       (absolute, below PT_USB_MOUNT_PATH). The file is truncated. */
+    esp_err_t pt_touch_record_start(const char *path);
+    /* Flush buffered frames and close the trace. Returns the first write error, if any. */
+    esp_err_t pt_touch_record_stop(void);
+    /* Append one frame; called by the LVGL glue for every live frame. Never blocks on I/O. */
+    void pt_touch_record_frame(const pt_touch_event_t *ev);
+
+    /* --------- Replay (also builds on a Linux host) --------- */
+
+    /* Load a trace file and start feeding it to the input device instead of the controller.
+       On ESP-IDF `path` goes through pt_usb_read(); on the host it is a plain file path. */
+    esp_err_t pt_touch_replay_start(const char *path, pt_touch_replay_mode_t mode);
+    /* Same from memory; `data` must stay valid until the replay ends */
+    esp_err_t pt_touch_replay_start_mem(const void *data, size_t len, pt_touch_replay_mode_t mode);
+    void pt_touch_replay_stop(void);
+    bool pt_touch_replay_active(void);
+
+    /* Next frame that is due, if any; `more` (optional) reports whether another one is already due.
+       A trace that ends with a finger down gets a synthetic lift frame. */
+    bool pt_touch_replay_next(pt_touch_event_t *ev, bool *more);
+
+    /* Called when a replayed frame becomes due (from a timer on ESP-IDF), so event-mode
+       input devices get read. Registered by the LVGL glue. */
+    void pt_touch_replay_set_notify(pt_touch_event_cb_t cb, void *arg);
+
+    void pt_touch_replay_get_status(pt_touch_replay_status_t *out);
+
+#ifdef __cplusplus
+}
+#endif
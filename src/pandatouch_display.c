@@ -1,11 +1,17 @@
 #include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
+#include "freertos/queue.h"
 #include "esp_log.h"
 #include "esp_timer.h"
 #include "esp_check.h"
 #include "esp_heap_caps.h"
+#include "esp_idf_version.h"
+#include "esp_memory_utils.h"
+#include "esp_cpu.h"
 #include "driver/ledc.h"
 #include "driver/gpio.h"
 
@@ -18,38 +24,258 @@
 #include "pandatouch_lvgl_touch.h"
 #include "pandatouch_board.h"
 
-#ifdef CONFIG_LV_USE_CUSTOM_MALLOC
-#ifdef CONFIG_PT_LVGL_USE_PT_INTERNAL_MALLOC
-void lv_mem_init(void)
+/* ====================== Logging / Globals ====================== */
+static const char *TAG = "PandaTouch::Display";
+static esp_lcd_panel_handle_t pt_lcd_panel_handle = NULL;
+static SemaphoreHandle_t pt_lvgl_mutex = NULL;
+static volatile uint32_t pt_backlight_setting = PT_BL_MAX;
+static lv_display_t *pt_disp = NULL;
+TaskHandle_t pt_task_handle_lvgl = NULL;
+static PT_LVGL_render_method_t pt_render_method = (PT_LVGL_render_method_t)CONFIG_PT_LVGL_RENDER_METHOD;
+static pt_display_coalesce_stats_t pt_coalesce_stats = {0};
+static pt_display_buffer_info_t pt_buf_info = {0};
+static void *pt_lvgl_bufs[2] = {NULL, NULL}; /* render buffers we own (not the DIRECT_2 panel framebuffers) */
+static uint8_t pt_panel_num_fbs = 0;
+
+/* Kconfig only defines the line count when a PARTIAL method is selected */
+#ifndef CONFIG_PT_LVGL_RENDER_PARTIAL_BUFFER_LINES
+#define CONFIG_PT_LVGL_RENDER_PARTIAL_BUFFER_LINES 80
+#endif
+
+#ifdef CONFIG_PT_LVGL_FLUSH_COALESCE
+/* Areas already invalidated in the current refresh cycle */
+#define PT_COALESCE_MAX_AREAS 16
+static lv_area_t pt_coalesce_areas[PT_COALESCE_MAX_AREAS];
+static uint32_t pt_coalesce_cnt = 0;
+#endif
+
+#ifdef CONFIG_PT_LVGL_FLUSH_ASYNC
+/* RGB panel reports the end of each draw_bitmap copy (IDF >= 5.3); older IDFs signal from the flush task */
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 3, 0)
+#define PT_FLUSH_READY_FROM_PANEL_CB 1
+#else
+#define PT_FLUSH_READY_FROM_PANEL_CB 0
+#endif
+
+typedef struct
 {
+    lv_display_t *disp;
+    lv_area_t area;
+    uint8_t *px_map;
+    int64_t input_us; /* input shown by this frame (last area only, 0: none) */
+} pt_flush_job_t;
+
+static QueueHandle_t pt_flush_queue = NULL;
+static TaskHandle_t pt_task_handle_flush = NULL;
+/* Queued or copying, not yet flush_ready. Incremented by the LVGL task (core 1), decremented by the
+   flush task or the panel callback (core 0). LVGL only has one flush in flight per display. */
+static _Atomic uint32_t pt_flush_inflight = 0;
+#define PT_FLUSH_DRAIN_TIMEOUT_MS 500
+#endif
+
+/* DIRECT_2: panel-owned framebuffers */
+static void *pt_direct_fbs[2] = {NULL, NULL};
+static SemaphoreHandle_t pt_vsync_sem = NULL;
+
+/* VSYNC pacing: frames scanned out so far, render divisor and frames without a render */
+static volatile uint32_t pt_vsync_count = 0;
+static volatile uint8_t pt_vsync_divisor = 1;
+static volatile uint32_t pt_missed_frames = 0;
+
+/* ====================== Frame statistics ====================== */
+#ifdef CONFIG_PT_DISPLAY_STATS
+#define PT_STATS_FRAME_BUCKETS 64 /* 1 ms buckets; the last one collects everything longer */
+
+typedef struct
+{
+    int64_t start_us;
+    uint32_t frames;
+    uint64_t render_us;
+    uint64_t flush_us;
+    uint32_t flush_count;
+    uint64_t bytes_pushed;
+    uint32_t lock_max_hold_us;
+    uint32_t frame_max_us;
+    uint32_t frame_hist[PT_STATS_FRAME_BUCKETS];
+    uint32_t input_frames;
+    uint32_t input_max_us;
+    uint32_t input_hist[PT_STATS_FRAME_BUCKETS];
+    uint32_t vsync_timeouts;
+} pt_stats_window_t;
+
+static pt_stats_window_t pt_stats = {0};
+static portMUX_TYPE pt_stats_mux = portMUX_INITIALIZER_UNLOCKED;
+static int64_t pt_stats_refr_start_us = 0;
+static int64_t pt_stats_render_start_us = 0;
+/* Input-to-flush latency: newest input sample consumed since the last refresh started, and the
+   one the refresh in progress shows (handed to the last flush of that frame) */
+static int64_t pt_stats_input_newest_us = 0;
+static int64_t pt_stats_input_frame_us = 0;
+
+/* `input_us`: timestamp of the input this frame shows, when `area` completes the frame (else 0) */
+static void pt_stats_flush_done(int64_t t0, const lv_area_t *area, int64_t input_us)
+{
+    const int64_t now = esp_timer_get_time();
+    const uint32_t us = (uint32_t)(now - t0);
+    const uint32_t bytes = (uint32_t)(area->x2 - area->x1 + 1) * (uint32_t)(area->y2 - area->y1 + 1) * sizeof(uint16_t);
+    uint32_t input_lat = 0;
+    uint32_t bucket = 0;
+    if (input_us)
+    {
+        const int64_t lat = now - input_us;
+        input_lat = lat < 0 ? 0 : (lat > UINT32_MAX ? UINT32_MAX : (uint32_t)lat);
+        bucket = input_lat / 1000;
+        if (bucket >= PT_STATS_FRAME_BUCKETS)
+            bucket = PT_STATS_FRAME_BUCKETS - 1;
+    }
+    portENTER_CRITICAL(&pt_stats_mux);
+    pt_stats.flush_us += us;
+    pt_stats.flush_count++;
+    pt_stats.bytes_pushed += bytes;
+    if (input_us)
+    {
+        pt_stats.input_frames++;
+        pt_stats.input_hist[bucket]++;
+        if (input_lat > pt_stats.input_max_us)
+            pt_stats.input_max_us = input_lat;
+    }
+    portEXIT_CRITICAL(&pt_stats_mux);
 }
-void *lv_malloc_core(size_t size)
+
+/* Called on the LVGL task while it renders the last area of a frame */
+static int64_t pt_stats_take_frame_input(lv_display_t *disp)
 {
-    return heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!lv_display_flush_is_last(disp))
+        return 0;
+    const int64_t t = pt_stats_input_frame_us;
+    pt_stats_input_frame_us = 0;
+    return t;
 }
 
-void *lv_realloc_core(void *p, size_t new_size)
+static void pt_stats_frame_done(uint32_t us)
 {
-    return heap_caps_realloc(p, new_size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    uint32_t bucket = us / 1000;
+    if (bucket >= PT_STATS_FRAME_BUCKETS)
+        bucket = PT_STATS_FRAME_BUCKETS - 1;
+    portENTER_CRITICAL(&pt_stats_mux);
+    pt_stats.frames++;
+    pt_stats.frame_hist[bucket]++;
+    if (us > pt_stats.frame_max_us)
+        pt_stats.frame_max_us = us;
+    portEXIT_CRITICAL(&pt_stats_mux);
 }
 
-void lv_free_core(void *p)
+static void pt_stats_vsync_timeout(void)
 {
-    heap_caps_free(p);
+    portENTER_CRITICAL(&pt_stats_mux);
+    pt_stats.vsync_timeouts++;
+    portEXIT_CRITICAL(&pt_stats_mux);
+}
+
+static uint32_t pt_stats_percentile_us(const uint32_t *hist, uint32_t count, uint32_t max_us, uint32_t pct)
+{
+    if (count == 0)
+        return 0;
+    const uint32_t target = (count * pct + 99) / 100;
+    uint32_t acc = 0;
+    for (uint32_t i = 0; i < PT_STATS_FRAME_BUCKETS; ++i)
+    {
+        acc += hist[i];
+        if (acc >= target)
+            return (i == PT_STATS_FRAME_BUCKETS - 1) ? max_us : (i + 1) * 1000;
+    }
+    return max_us;
 }
+#define PT_STATS_NOW() esp_timer_get_time()
+#else
+#define PT_STATS_NOW() 0
+#define pt_stats_flush_done(t0, area, input_us) ((void)(t0), (void)(area), (void)(input_us))
+#define pt_stats_take_frame_input(disp) ((void)(disp), (int64_t)0)
+#define pt_stats_vsync_timeout() ((void)0)
 #endif
+
+/* ====================== LVGL mutex ====================== */
+#if defined(CONFIG_PT_DISPLAY_STATS) || defined(CONFIG_PT_LVGL_LOCK_PROFILER)
+/* Outermost pt_lvgl_lock() holder: nesting depth and acquisition time (guarded by the mutex) */
+static uint32_t pt_lock_depth = 0;
+static int64_t pt_lock_taken_us = 0;
 #endif
 
-/* ====================== Logging / Globals ====================== */
-static const char *TAG = "PandaTouch::Display";
-static esp_lcd_panel_handle_t pt_lcd_panel_handle = NULL;
-static esp_timer_handle_t pt_lvgl_tick = NULL;
-static SemaphoreHandle_t pt_lvgl_mutex = NULL;
-static volatile uint32_t pt_backlight_setting = PT_BL_MAX;
-static lv_display_t *pt_disp = NULL;
-TaskHandle_t pt_task_handle_lvgl = NULL;
+#ifdef CONFIG_PT_LVGL_LOCK_PROFILER
+/* One slot per (task, call site); the last slot collects callers that did not fit.
+   Slots are only written while holding the LVGL mutex, so they need no locking of their own. */
+#define PT_LOCK_PROF_SLOTS CONFIG_PT_LVGL_LOCK_PROFILER_SLOTS
+
+typedef struct
+{
+    TaskHandle_t task;
+    pt_lvgl_lock_profile_entry_t e;
+} pt_lock_prof_slot_t;
+
+static pt_lock_prof_slot_t pt_lock_prof[PT_LOCK_PROF_SLOTS];
+static uint32_t pt_lock_prof_used = 0;
+static pt_lock_prof_slot_t *pt_lock_prof_owner = NULL; /* slot of the current outermost holder */
+
+static pt_lock_prof_slot_t *pt_lock_prof_slot(const void *caller)
+{
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    for (uint32_t i = 0; i < pt_lock_prof_used; ++i)
+    {
+        if (pt_lock_prof[i].task == task && pt_lock_prof[i].e.caller == caller)
+            return &pt_lock_prof[i];
+    }
+    pt_lock_prof_slot_t *slot = &pt_lock_prof[PT_LOCK_PROF_SLOTS - 1];
+    if (pt_lock_prof_used < PT_LOCK_PROF_SLOTS - 1)
+    {
+        slot = &pt_lock_prof[pt_lock_prof_used++];
+        slot->task = task;
+        slot->e.caller = caller;
+        snprintf(slot->e.task_name, sizeof(slot->e.task_name), "%s", pcTaskGetName(task));
+    }
+    else if (slot->e.task_name[0] == '\0')
+    {
+        snprintf(slot->e.task_name, sizeof(slot->e.task_name), "(other)");
+    }
+    return slot;
+}
+
+static void pt_lock_prof_acquired(const void *caller, uint32_t wait_us)
+{
+    pt_lock_prof_slot_t *slot = pt_lock_prof_slot(caller);
+    slot->e.count++;
+    slot->e.wait_total_us += wait_us;
+    if (wait_us > slot->e.wait_max_us)
+        slot->e.wait_max_us = wait_us;
+    pt_lock_prof_owner = slot;
+}
+
+static void pt_lock_prof_released(uint32_t held_us)
+{
+    pt_lock_prof_slot_t *slot = pt_lock_prof_owner;
+    pt_lock_prof_owner = NULL;
+    if (!slot)
+        return; /* profile was reset while this holder had the lock */
+    slot->e.hold_total_us += held_us;
+    if (held_us > slot->e.hold_max_us)
+        slot->e.hold_max_us = held_us;
+}
+
+#if defined(CONFIG_PT_LVGL_LOCK_PROFILER) && CONFIG_PT_LVGL_LOCK_PROFILER_LOG_PERIOD_S > 0
+/* Called by the LVGL task outside the lock */
+static void pt_lock_prof_periodic(void)
+{
+    static int64_t last_us = 0;
+    const int64_t now = esp_timer_get_time();
+    if (last_us == 0)
+        last_us = now;
+    if (now - last_us < (int64_t)CONFIG_PT_LVGL_LOCK_PROFILER_LOG_PERIOD_S * 1000000)
+        return;
+    last_us = now;
+    pt_lvgl_lock_profile_dump(true);
+}
+#endif
+#endif
 
-/* ====================== LVGL mutex ====================== */
 static void pt_display_ensure_lvgl_mutex(void)
 {
     if (pt_lvgl_mutex == NULL)
@@ -61,14 +287,110 @@ static void pt_display_ensure_lvgl_mutex(void)
 
 void pt_lvgl_lock(void)
 {
-    if (pt_lvgl_mutex)
-        xSemaphoreTakeRecursive(pt_lvgl_mutex, portMAX_DELAY);
+    if (!pt_lvgl_mutex)
+        return;
+#ifdef CONFIG_PT_LVGL_LOCK_PROFILER
+    const int64_t t0 = esp_timer_get_time();
+#endif
+    xSemaphoreTakeRecursive(pt_lvgl_mutex, portMAX_DELAY);
+#if defined(CONFIG_PT_DISPLAY_STATS) || defined(CONFIG_PT_LVGL_LOCK_PROFILER)
+    if (pt_lock_depth++ == 0)
+    {
+        pt_lock_taken_us = esp_timer_get_time();
+#ifdef CONFIG_PT_LVGL_LOCK_PROFILER
+        pt_lock_prof_acquired((const void *)esp_cpu_process_stack_pc((intptr_t)__builtin_return_address(0)),
+                              (uint32_t)(pt_lock_taken_us - t0));
+#endif
+    }
+#endif
 }
 
 void pt_lvgl_unlock(void)
 {
-    if (pt_lvgl_mutex)
-        xSemaphoreGiveRecursive(pt_lvgl_mutex);
+    if (!pt_lvgl_mutex)
+        return;
+#if defined(CONFIG_PT_DISPLAY_STATS) || defined(CONFIG_PT_LVGL_LOCK_PROFILER)
+    if (pt_lock_depth > 0 && --pt_lock_depth == 0)
+    {
+        const uint32_t held = (uint32_t)(esp_timer_get_time() - pt_lock_taken_us);
+#ifdef CONFIG_PT_DISPLAY_STATS
+        portENTER_CRITICAL(&pt_stats_mux);
+        if (held > pt_stats.lock_max_hold_us)
+            pt_stats.lock_max_hold_us = held;
+        portEXIT_CRITICAL(&pt_stats_mux);
+#endif
+#ifdef CONFIG_PT_LVGL_LOCK_PROFILER
+        pt_lock_prof_released(held);
+#endif
+    }
+#endif
+    xSemaphoreGiveRecursive(pt_lvgl_mutex);
+}
+
+size_t pt_lvgl_lock_profile_get(pt_lvgl_lock_profile_entry_t *out, size_t max, bool reset)
+{
+#ifdef CONFIG_PT_LVGL_LOCK_PROFILER
+    if (!pt_lvgl_mutex)
+        return 0;
+    size_t n = 0;
+    /* Raw take: reading the profile should not show up in it */
+    xSemaphoreTakeRecursive(pt_lvgl_mutex, portMAX_DELAY);
+    for (uint32_t i = 0; i < PT_LOCK_PROF_SLOTS && n < max && out; ++i)
+    {
+        if (pt_lock_prof[i].e.count)
+            out[n++] = pt_lock_prof[i].e;
+    }
+    if (reset)
+    {
+        memset(pt_lock_prof, 0, sizeof(pt_lock_prof));
+        pt_lock_prof_used = 0;
+        pt_lock_prof_owner = NULL;
+    }
+    xSemaphoreGiveRecursive(pt_lvgl_mutex);
+    return n;
+#else
+    (void)out;
+    (void)max;
+    (void)reset;
+    return 0;
+#endif
+}
+
+void pt_lvgl_lock_profile_dump(bool reset)
+{
+#ifdef CONFIG_PT_LVGL_LOCK_PROFILER
+    pt_lvgl_lock_profile_entry_t *entries = heap_caps_malloc(sizeof(*entries) * PT_LOCK_PROF_SLOTS, MALLOC_CAP_DEFAULT);
+    if (!entries)
+    {
+        ESP_LOGW(TAG, "lock profile: out of memory");
+        return;
+    }
+    const size_t n = pt_lvgl_lock_profile_get(entries, PT_LOCK_PROF_SLOTS, reset);
+
+    /* Longest total wait first */
+    for (size_t i = 1; i < n; ++i)
+    {
+        const pt_lvgl_lock_profile_entry_t tmp = entries[i];
+        size_t j = i;
+        for (; j > 0 && entries[j - 1].wait_total_us < tmp.wait_total_us; --j)
+            entries[j] = entries[j - 1];
+        entries[j] = tmp;
+    }
+
+    ESP_LOGI(TAG, "LVGL lock profile: %u caller(s)", (unsigned)n);
+    ESP_LOGI(TAG, "  %-16s %-10s %8s %10s %9s %10s %9s", "task", "caller", "count", "wait(ms)", "wmax(us)", "hold(ms)", "hmax(us)");
+    for (size_t i = 0; i < n; ++i)
+    {
+        const pt_lvgl_lock_profile_entry_t *e = &entries[i];
+        ESP_LOGI(TAG, "  %-16s %10p %8lu %10lu %9lu %10lu %9lu", e->task_name, e->caller, (unsigned long)e->count,
+                 (unsigned long)(e->wait_total_us / 1000), (unsigned long)e->wait_max_us,
+                 (unsigned long)(e->hold_total_us / 1000), (unsigned long)e->hold_max_us);
+    }
+    heap_caps_free(entries);
+#else
+    (void)reset;
+    ESP_LOGW(TAG, "lock profiler disabled (PT_LVGL_LOCK_PROFILER)");
+#endif
 }
 
 /* ====================== Backlight helpers ====================== */
@@ -143,7 +465,7 @@ bool pt_backlight_set(uint32_t percent)
 }
 
 /* ====================== Panel init ====================== */
-static esp_err_t pt_lcd_panel_init(void)
+static esp_err_t pt_lcd_panel_init(PT_LVGL_render_method_t method)
 {
     esp_lcd_rgb_panel_config_t cfg = {
         .clk_src = LCD_CLK_SRC_DEFAULT,
@@ -164,7 +486,7 @@ static esp_err_t pt_lcd_panel_init(void)
                 .de_idle_high = false},
         },
         .data_width = 16,
-        .num_fbs = 0, /* LVGL owns buffers */
+        .num_fbs = (method == PT_LVGL_RENDER_DIRECT_2) ? 2 : 0, /* LVGL owns buffers unless DIRECT_2 */
         .bounce_buffer_size_px = CONFIG_PT_LVGL_RENDER_BOUNCING_BUFFER_LINES * PT_LCD_H_RES,
         .psram_trans_align = 64,
         .hsync_gpio_num = PT_LCD_HSYNC_PIN,
@@ -177,26 +499,310 @@ static esp_err_t pt_lcd_panel_init(void)
     };
 
     ESP_RETURN_ON_ERROR(esp_lcd_new_rgb_panel(&cfg, &pt_lcd_panel_handle), TAG, "esp_lcd_new_rgb_panel");
+    pt_panel_num_fbs = (uint8_t)cfg.num_fbs;
     ESP_RETURN_ON_ERROR(esp_lcd_panel_reset(pt_lcd_panel_handle), TAG, "panel_reset");
     ESP_RETURN_ON_ERROR(esp_lcd_panel_init(pt_lcd_panel_handle), TAG, "panel_init");
     return ESP_OK;
 }
 
 /* ====================== LVGL flush & tick ====================== */
+static bool pt_lcd_on_vsync(esp_lcd_panel_handle_t panel, const esp_lcd_rgb_panel_event_data_t *edata, void *user_ctx)
+{
+    (void)panel;
+    (void)edata;
+    (void)user_ctx;
+    BaseType_t woken = pdFALSE;
+    pt_vsync_count++;
+    if (pt_vsync_sem)
+        xSemaphoreGiveFromISR(pt_vsync_sem, &woken);
+#ifdef CONFIG_PT_LVGL_TASK_PACING_VSYNC
+    if (pt_task_handle_lvgl)
+        vTaskNotifyGiveFromISR(pt_task_handle_lvgl, &woken);
+#endif
+    return woken == pdTRUE;
+}
+
+static void pt_lvgl_flush_direct_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
+{
+    const int64_t t0 = PT_STATS_NOW();
+    if (!lv_display_flush_is_last(disp))
+    {
+        /* LVGL rendered straight into the framebuffer; nothing to copy yet */
+        pt_stats_flush_done(t0, area, 0);
+        lv_display_flush_ready(disp);
+        return;
+    }
+
+    esp_lcd_panel_handle_t panel = (esp_lcd_panel_handle_t)lv_display_get_user_data(disp);
+    if (panel)
+    {
+        /* Drop a stale VSYNC before switching, so the wait below sees the one after the switch */
+        xSemaphoreTake(pt_vsync_sem, 0);
+        /* Passing one of the panel's own framebuffers switches scanout to it (no copy) */
+        esp_lcd_panel_draw_bitmap(panel, 0, 0, PT_LCD_H_RES, PT_LCD_V_RES, px_map);
+        /* The switch happens at the next VSYNC; until then the old buffer is still scanned out */
+        if (xSemaphoreTake(pt_vsync_sem, pdMS_TO_TICKS(100)) != pdTRUE)
+        {
+            /* LVGL will render into a buffer that may still be on screen: this frame can tear */
+            static uint32_t timeouts = 0;
+            if ((timeouts++ & 63) == 0)
+                ESP_LOGW(TAG, "DIRECT_2: no VSYNC within 100 ms after a buffer swap (%lu so far)", (unsigned long)timeouts);
+            pt_stats_vsync_timeout();
+        }
+    }
+
+    /* No copy into the other buffer: LVGL syncs last frame's areas into it at the start of the
+       next refresh (skipping the ones it is about to redraw) */
+    pt_stats_flush_done(t0, area, pt_stats_take_frame_input(disp));
+    lv_display_flush_ready(disp);
+}
+
 static void pt_lvgl_flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
 {
+    pt_coalesce_stats.transfers_out++;
+    if (pt_direct_fbs[0])
+    {
+        pt_lvgl_flush_direct_cb(disp, area, px_map);
+        return;
+    }
+#ifdef CONFIG_PT_LVGL_FLUSH_ASYNC
+    /* Hand the area to the flush task; LVGL keeps rendering into the other buffer */
+    pt_flush_job_t job = {.disp = disp, .area = *area, .px_map = px_map, .input_us = pt_stats_take_frame_input(disp)};
+    if (pt_flush_queue)
+    {
+        atomic_fetch_add(&pt_flush_inflight, 1);
+        if (xQueueSend(pt_flush_queue, &job, portMAX_DELAY) == pdTRUE)
+            return;
+        atomic_fetch_sub(&pt_flush_inflight, 1);
+    }
+#endif
+    const int64_t t0 = PT_STATS_NOW();
     esp_lcd_panel_handle_t panel = (esp_lcd_panel_handle_t)lv_display_get_user_data(disp);
     if (panel)
     {
         /* esp_lcd x2/y2 are exclusive -> +1 */
         esp_lcd_panel_draw_bitmap(panel, area->x1, area->y1, area->x2 + 1, area->y2 + 1, px_map);
     }
+    pt_stats_flush_done(t0, area, pt_stats_take_frame_input(disp));
     lv_display_flush_ready(disp);
 }
-static void pt_lvgl_tick_cb(void *arg)
+#ifdef CONFIG_PT_LVGL_FLUSH_ASYNC
+#if PT_FLUSH_READY_FROM_PANEL_CB
+static bool pt_lcd_on_color_trans_done(esp_lcd_panel_handle_t panel, const esp_lcd_rgb_panel_event_data_t *edata, void *user_ctx)
+{
+    (void)panel;
+    (void)edata;
+    /* DIRECT_2 and synchronous fallbacks signal flush_ready themselves */
+    if (pt_direct_fbs[0])
+        return false;
+    uint32_t n = atomic_load(&pt_flush_inflight);
+    do
+    {
+        if (n == 0)
+            return false;
+    } while (!atomic_compare_exchange_weak(&pt_flush_inflight, &n, n - 1));
+    lv_display_flush_ready((lv_display_t *)user_ctx);
+    return false;
+}
+#endif
+
+static void pt_lvgl_flush_task(void *arg)
 {
     (void)arg;
-    lv_tick_inc(2);
+    pt_flush_job_t job;
+    while (true)
+    {
+        if (xQueueReceive(pt_flush_queue, &job, portMAX_DELAY) != pdTRUE)
+            continue;
+
+        const int64_t t0 = PT_STATS_NOW();
+        esp_lcd_panel_handle_t panel = (esp_lcd_panel_handle_t)lv_display_get_user_data(job.disp);
+        esp_err_t err = ESP_FAIL;
+        if (panel)
+        {
+            /* esp_lcd x2/y2 are exclusive -> +1 */
+            err = esp_lcd_panel_draw_bitmap(panel, job.area.x1, job.area.y1, job.area.x2 + 1, job.area.y2 + 1, job.px_map);
+        }
+        pt_stats_flush_done(t0, &job.area, job.input_us);
+        /* On success the panel callback already released the buffer */
+        if (!PT_FLUSH_READY_FROM_PANEL_CB || err != ESP_OK)
+        {
+            atomic_fetch_sub(&pt_flush_inflight, 1);
+            lv_display_flush_ready(job.disp);
+        }
+    }
+}
+
+static esp_err_t pt_lvgl_flush_async_init(void)
+{
+    if (pt_flush_queue)
+        return ESP_OK;
+
+    pt_flush_queue = xQueueCreate(CONFIG_PT_LVGL_FLUSH_QUEUE_DEPTH, sizeof(pt_flush_job_t));
+    if (!pt_flush_queue)
+        return ESP_ERR_NO_MEM;
+
+    /* Copy on core 0 while LVGL renders on core 1 */
+    if (xTaskCreatePinnedToCore(pt_lvgl_flush_task, "lvgl_flush", 3072, NULL, 5, &pt_task_handle_flush, 0) != pdPASS)
+    {
+        vQueueDelete(pt_flush_queue);
+        pt_flush_queue = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "Async flush enabled (queue depth %d)", CONFIG_PT_LVGL_FLUSH_QUEUE_DEPTH);
+    return ESP_OK;
+}
+#endif
+
+/* One registration for every panel event the display path relies on */
+static esp_err_t pt_lcd_register_callbacks(lv_display_t *disp)
+{
+    if (pt_vsync_sem == NULL)
+    {
+        pt_vsync_sem = xSemaphoreCreateBinary();
+        if (!pt_vsync_sem)
+            return ESP_ERR_NO_MEM;
+    }
+
+    esp_lcd_rgb_panel_event_callbacks_t cbs = {
+        .on_vsync = pt_lcd_on_vsync,
+    };
+#if defined(CONFIG_PT_LVGL_FLUSH_ASYNC) && PT_FLUSH_READY_FROM_PANEL_CB
+    cbs.on_color_trans_done = pt_lcd_on_color_trans_done;
+#endif
+    ESP_RETURN_ON_ERROR(esp_lcd_rgb_panel_register_event_callbacks(pt_lcd_panel_handle, &cbs, disp), TAG, "register_event_callbacks");
+    return ESP_OK;
+}
+
+/* LVGL reads time on demand instead of being ticked by a periodic timer */
+static uint32_t pt_lvgl_tick_get_cb(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+/* ====================== Flush coalescing ====================== */
+#ifdef CONFIG_PT_LVGL_FLUSH_COALESCE
+static inline uint32_t pt_area_px(const lv_area_t *a)
+{
+    return (uint32_t)(a->x2 - a->x1 + 1) * (uint32_t)(a->y2 - a->y1 + 1);
+}
+
+static inline bool pt_waste_ok(uint32_t used, uint32_t total)
+{
+    return (uint64_t)(total - used) * 100u <= (uint64_t)total * CONFIG_PT_LVGL_FLUSH_COALESCE_WASTE_PCT;
+}
+
+/* Grow `a` to the union with `b` if the pixels neither of them covers stay under the threshold */
+static bool pt_coalesce_try_merge(lv_area_t *a, const lv_area_t *b)
+{
+    lv_area_t u = {
+        .x1 = LV_MIN(a->x1, b->x1),
+        .y1 = LV_MIN(a->y1, b->y1),
+        .x2 = LV_MAX(a->x2, b->x2),
+        .y2 = LV_MAX(a->y2, b->y2),
+    };
+    uint32_t used = pt_area_px(a) + pt_area_px(b);
+    lv_area_t i = {
+        .x1 = LV_MAX(a->x1, b->x1),
+        .y1 = LV_MAX(a->y1, b->y1),
+        .x2 = LV_MIN(a->x2, b->x2),
+        .y2 = LV_MIN(a->y2, b->y2),
+    };
+    if (i.x1 <= i.x2 && i.y1 <= i.y2)
+        used -= pt_area_px(&i);
+    if (!pt_waste_ok(used, pt_area_px(&u)))
+        return false;
+    *a = u;
+    return true;
+}
+
+static void pt_coalesce_area(lv_area_t *area)
+{
+    /* Full-width rows are one contiguous block in the framebuffer: one copy, one writeback */
+    const int32_t w = area->x2 - area->x1 + 1;
+    if (w < PT_LCD_H_RES && pt_waste_ok((uint32_t)w, PT_LCD_H_RES))
+    {
+        area->x1 = 0;
+        area->x2 = PT_LCD_H_RES - 1;
+        pt_coalesce_stats.areas_merged++;
+    }
+
+    /* Absorb earlier areas; LVGL then drops them since `area` covers them */
+    bool merged;
+    do
+    {
+        merged = false;
+        for (uint32_t i = 0; i < pt_coalesce_cnt; ++i)
+        {
+            if (pt_coalesce_try_merge(area, &pt_coalesce_areas[i]))
+            {
+                pt_coalesce_areas[i] = pt_coalesce_areas[--pt_coalesce_cnt];
+                pt_coalesce_stats.areas_merged++;
+                merged = true;
+                break;
+            }
+        }
+    } while (merged);
+
+    if (pt_coalesce_cnt < PT_COALESCE_MAX_AREAS)
+        pt_coalesce_areas[pt_coalesce_cnt++] = *area;
+}
+#endif
+
+static void pt_lvgl_display_event_cb(lv_event_t *e)
+{
+    lv_event_code_t code = lv_event_get_code(e);
+    if (code == LV_EVENT_INVALIDATE_AREA)
+    {
+        pt_coalesce_stats.areas_in++;
+#ifdef CONFIG_PT_LVGL_FLUSH_COALESCE
+        lv_area_t *area = (lv_area_t *)lv_event_get_param(e);
+        if (area && pt_render_method != PT_LVGL_RENDER_FULL_1 && pt_render_method != PT_LVGL_RENDER_FULL_2)
+            pt_coalesce_area(area);
+#endif
+        pt_display_wake();
+    }
+    else if (code == LV_EVENT_REFR_READY)
+    {
+#ifdef CONFIG_PT_LVGL_FLUSH_COALESCE
+        pt_coalesce_cnt = 0;
+#endif
+#ifdef CONFIG_PT_DISPLAY_STATS
+        if (pt_stats_refr_start_us)
+            pt_stats_frame_done((uint32_t)(esp_timer_get_time() - pt_stats_refr_start_us));
+        pt_stats_refr_start_us = 0;
+        /* A refresh that flushed nothing never took its input: do not charge it to a later frame */
+        pt_stats_input_frame_us = 0;
+#endif
+    }
+    else if (code == LV_EVENT_REFR_START)
+    {
+#ifdef CONFIG_PT_LVGL_TOUCH_FRAME_SYNC
+        /* Layout and invalid areas are processed after this event: input read now lands in this frame */
+        pt_lvgl_touch_frame_sync();
+#endif
+#ifdef CONFIG_PT_DISPLAY_STATS
+        pt_stats_refr_start_us = esp_timer_get_time();
+        if (pt_stats_input_newest_us)
+        {
+            pt_stats_input_frame_us = pt_stats_input_newest_us;
+            pt_stats_input_newest_us = 0;
+        }
+#endif
+    }
+#ifdef CONFIG_PT_DISPLAY_STATS
+    else if (code == LV_EVENT_RENDER_START)
+    {
+        pt_stats_render_start_us = esp_timer_get_time();
+    }
+    else if (code == LV_EVENT_RENDER_READY)
+    {
+        const uint32_t us = (uint32_t)(esp_timer_get_time() - pt_stats_render_start_us);
+        portENTER_CRITICAL(&pt_stats_mux);
+        pt_stats.render_us += us;
+        portEXIT_CRITICAL(&pt_stats_mux);
+    }
+#endif
 }
 
 /* ====================== Buffers ====================== */
@@ -208,9 +814,19 @@ static void *pt_malloc_caps(size_t sz, uint32_t caps_primary, uint32_t caps_fall
     return p;
 }
 
-static bool pt_lvgl_setup_buffers(lv_display_t *disp, int hor_res, int ver_res, PT_LVGL_render_method_t method)
+/* Release render buffers we allocated (panel-owned DIRECT_2 framebuffers are never freed) */
+static void pt_lvgl_record_buffers(PT_LVGL_render_method_t method, void *b1, void *b2, size_t bytes, int lines)
+{
+    pt_buf_info.method = method;
+    pt_buf_info.buf_bytes = (uint32_t)bytes;
+    pt_buf_info.buf_count = b2 ? 2 : 1;
+    pt_buf_info.partial_lines = (uint16_t)lines;
+    pt_buf_info.in_psram = esp_ptr_external_ram(b1);
+}
+
+static bool pt_lvgl_setup_buffers(lv_display_t *disp, int hor_res, int ver_res, PT_LVGL_render_method_t method, int partial_lines)
 {
-    const size_t px_size = sizeof(lv_color_t);
+    const size_t px_size = sizeof(lv_color16_t); /* RGB565 */
     const size_t full_bytes = (size_t)hor_res * (size_t)ver_res * px_size;
 
     switch (method)
@@ -220,7 +836,9 @@ static bool pt_lvgl_setup_buffers(lv_display_t *disp, int hor_res, int ver_res,
         lv_color_t *fb1 = (lv_color_t *)pt_malloc_caps(full_bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT, MALLOC_CAP_8BIT);
         if (!fb1)
             return false;
+        pt_lvgl_bufs[0] = fb1;
         lv_display_set_buffers(disp, fb1, NULL, full_bytes, LV_DISPLAY_RENDER_MODE_FULL);
+        pt_lvgl_record_buffers(method, fb1, NULL, full_bytes, 0);
         ESP_LOGI(TAG, "Buffers: FULL_1 (1x %u KB PSRAM)", (unsigned)(full_bytes / 1024));
         break;
     }
@@ -236,7 +854,10 @@ static bool pt_lvgl_setup_buffers(lv_display_t *disp, int hor_res, int ver_res,
                 heap_caps_free(fb2);
             return false;
         }
+        pt_lvgl_bufs[0] = fb1;
+        pt_lvgl_bufs[1] = fb2;
         lv_display_set_buffers(disp, fb1, fb2, full_bytes, LV_DISPLAY_RENDER_MODE_FULL);
+        pt_lvgl_record_buffers(method, fb1, fb2, full_bytes, 0);
         ESP_LOGI(TAG, "Buffers: FULL_2 (2x %u KB PSRAM)", (unsigned)(full_bytes / 1024));
         break;
     }
@@ -245,7 +866,7 @@ static bool pt_lvgl_setup_buffers(lv_display_t *disp, int hor_res, int ver_res,
     case PT_LVGL_RENDER_PARTIAL_1_PSRAM:
     case PT_LVGL_RENDER_PARTIAL_2_PSRAM:
     {
-        const int lines = CONFIG_PT_LVGL_RENDER_PARTIAL_BUFFER_LINES;
+        const int lines = partial_lines;
         const size_t part_bytes = (size_t)hor_res * (size_t)lines * px_size;
         const bool psram_first = (method == PT_LVGL_RENDER_PARTIAL_1_PSRAM || method == PT_LVGL_RENDER_PARTIAL_2_PSRAM);
         const uint32_t caps_int = MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA | MALLOC_CAP_8BIT;
@@ -259,25 +880,40 @@ static bool pt_lvgl_setup_buffers(lv_display_t *disp, int hor_res, int ver_res,
             return false;
 
         const bool pingpong = (method == PT_LVGL_RENDER_PARTIAL_2 || method == PT_LVGL_RENDER_PARTIAL_2_PSRAM);
+        lv_color_t *pb2 = NULL;
         if (pingpong)
         {
-            lv_color_t *pb2 = (lv_color_t *)pt_malloc_caps(part_bytes, primary, fallback);
+            pb2 = (lv_color_t *)pt_malloc_caps(part_bytes, primary, fallback);
             if (!pb2)
             {
                 heap_caps_free(pb1);
                 return false;
             }
-            lv_display_set_buffers(disp, pb1, pb2, part_bytes, LV_DISPLAY_RENDER_MODE_PARTIAL);
-        }
-        else
-        {
-            lv_display_set_buffers(disp, pb1, NULL, part_bytes, LV_DISPLAY_RENDER_MODE_PARTIAL);
         }
+        pt_lvgl_bufs[0] = pb1;
+        pt_lvgl_bufs[1] = pb2;
+        lv_display_set_buffers(disp, pb1, pb2, part_bytes, LV_DISPLAY_RENDER_MODE_PARTIAL);
+        pt_lvgl_record_buffers(method, pb1, pb2, part_bytes, lines);
 
-        ESP_LOGI(TAG, "Buffers: %s (line %u KB, %d lines, %s-first)",
+        ESP_LOGI(TAG, "Buffers: %s (line %u KB, %d lines, %s-first, got %s)",
                  (pingpong ? "PARTIAL_2" : "PARTIAL_1"),
                  (unsigned)(part_bytes / 1024), lines,
-                 psram_first ? "PSRAM" : "INTERNAL");
+                 psram_first ? "PSRAM" : "INTERNAL",
+                 pt_buf_info.in_psram ? "PSRAM" : "INTERNAL");
+        break;
+    }
+    case PT_LVGL_RENDER_DIRECT_2:
+    {
+        void *fb0 = NULL, *fb1 = NULL;
+        if (pt_panel_num_fbs != 2)
+            return false;
+        if (esp_lcd_rgb_panel_get_frame_buffer(pt_lcd_panel_handle, 2, &fb0, &fb1) != ESP_OK || !fb0 || !fb1)
+            return false;
+        pt_direct_fbs[0] = fb0;
+        pt_direct_fbs[1] = fb1;
+        lv_display_set_buffers(disp, fb0, fb1, full_bytes, LV_DISPLAY_RENDER_MODE_DIRECT);
+        pt_lvgl_record_buffers(method, fb0, fb1, full_bytes, 0);
+        ESP_LOGI(TAG, "Buffers: DIRECT_2 (2x %u KB panel framebuffers, PSRAM)", (unsigned)(full_bytes / 1024));
         break;
     }
     default:
@@ -309,44 +945,230 @@ static esp_err_t pt_lvgl_display_init(lv_display_t **out_disp,
     lv_display_set_flush_cb(disp, flush_cb ? flush_cb : pt_lvgl_flush_cb);
     lv_display_set_user_data(disp, user_data ? user_data : pt_lcd_panel_handle);
 
-    if (!pt_lvgl_setup_buffers(disp, hor_res, ver_res, method))
+    if (!pt_lvgl_setup_buffers(disp, hor_res, ver_res, method, CONFIG_PT_LVGL_RENDER_PARTIAL_BUFFER_LINES))
     {
         ESP_LOGE(TAG, "LVGL buffer setup failed");
         return ESP_ERR_NO_MEM;
     }
 
+    ESP_RETURN_ON_ERROR(pt_lcd_register_callbacks(disp), TAG, "register_callbacks");
+#ifdef CONFIG_PT_LVGL_FLUSH_ASYNC
+    if ((!flush_cb || flush_cb == pt_lvgl_flush_cb) && !pt_direct_fbs[0])
+        ESP_RETURN_ON_ERROR(pt_lvgl_flush_async_init(), TAG, "flush_async_init");
+#endif
+
     *out_disp = disp;
     return ESP_OK;
 }
 
-/* ====================== LVGL runtime (tick + task) ====================== */
+/* ====================== UI command queue ====================== */
+/* Lock-free MPSC queue: any task or ISR posts, the LVGL task drains it once per pass.
+   Nodes come from a fixed pool whose free list is a Treiber stack; its head carries an
+   ABA tag in the upper 16 bits. Producers push onto `pt_ui_pending` with a CAS and the
+   LVGL task takes the whole list with one exchange, so nothing here blocks or allocates. */
+#define PT_UI_NIL 0xFFFFu
+
+typedef struct
+{
+    pt_ui_fn_t fn;
+    void *arg;
+    uint32_t key;
+    uint16_t next;
+} pt_ui_node_t;
+
+static pt_ui_node_t pt_ui_pool[CONFIG_PT_DISPLAY_UI_QUEUE_SIZE];
+static _Atomic uint32_t pt_ui_free = PT_UI_NIL;    /* tag << 16 | head index */
+static _Atomic uint32_t pt_ui_pending = PT_UI_NIL; /* head index, newest first */
+static _Atomic uint32_t pt_ui_posted = 0;
+static _Atomic uint32_t pt_ui_exhausted = 0;
+static uint32_t pt_ui_executed = 0; /* LVGL task only */
+static uint32_t pt_ui_coalesced = 0;
+/* Drain scratch (LVGL task only): surviving nodes and the keys already kept */
+static uint16_t pt_ui_batch[CONFIG_PT_DISPLAY_UI_QUEUE_SIZE];
+static uint32_t pt_ui_seen_keys[CONFIG_PT_DISPLAY_UI_QUEUE_SIZE];
+
+static void pt_ui_queue_init(void)
+{
+    for (uint32_t i = 0; i < CONFIG_PT_DISPLAY_UI_QUEUE_SIZE; ++i)
+        pt_ui_pool[i].next = (i + 1 < CONFIG_PT_DISPLAY_UI_QUEUE_SIZE) ? (uint16_t)(i + 1) : PT_UI_NIL;
+    atomic_store(&pt_ui_free, 0);
+}
+
+static uint16_t pt_ui_node_alloc(void)
+{
+    uint32_t head = atomic_load_explicit(&pt_ui_free, memory_order_acquire);
+    while ((head & 0xFFFFu) != PT_UI_NIL)
+    {
+        const uint32_t next = ((head + 0x10000u) & 0xFFFF0000u) | pt_ui_pool[head & 0xFFFFu].next;
+        if (atomic_compare_exchange_weak_explicit(&pt_ui_free, &head, next, memory_order_acquire, memory_order_acquire))
+            return (uint16_t)(head & 0xFFFFu);
+    }
+    return PT_UI_NIL;
+}
+
+static void pt_ui_node_release(uint16_t idx)
+{
+    uint32_t head = atomic_load_explicit(&pt_ui_free, memory_order_relaxed);
+    uint32_t next;
+    do
+    {
+        pt_ui_pool[idx].next = (uint16_t)(head & 0xFFFFu);
+        next = ((head + 0x10000u) & 0xFFFF0000u) | idx;
+    } while (!atomic_compare_exchange_weak_explicit(&pt_ui_free, &head, next, memory_order_release, memory_order_relaxed));
+}
+
+static bool pt_ui_queue_post(pt_ui_fn_t fn, void *arg, uint32_t key)
+{
+    const uint16_t idx = pt_ui_node_alloc();
+    if (idx == PT_UI_NIL)
+    {
+        atomic_fetch_add_explicit(&pt_ui_exhausted, 1, memory_order_relaxed);
+        return false;
+    }
+    pt_ui_node_t *node = &pt_ui_pool[idx];
+    node->fn = fn;
+    node->arg = arg;
+    node->key = key;
+    uint32_t head = atomic_load_explicit(&pt_ui_pending, memory_order_relaxed);
+    do
+    {
+        node->next = (uint16_t)head;
+    } while (!atomic_compare_exchange_weak_explicit(&pt_ui_pending, &head, idx, memory_order_release, memory_order_relaxed));
+    atomic_fetch_add_explicit(&pt_ui_posted, 1, memory_order_relaxed);
+    pt_display_wake();
+    return true;
+}
+
+static inline bool pt_ui_queue_empty(void)
+{
+    return atomic_load_explicit(&pt_ui_pending, memory_order_relaxed) == PT_UI_NIL;
+}
+
+/* Called by the LVGL task with the LVGL lock held */
+static void pt_ui_queue_drain(void)
+{
+    uint32_t idx = atomic_exchange_explicit(&pt_ui_pending, PT_UI_NIL, memory_order_acquire);
+    uint32_t batch = 0, seen = 0;
+
+    /* The list is newest first: keep the first node of each key, drop older ones */
+    while (idx != PT_UI_NIL)
+    {
+        pt_ui_node_t *node = &pt_ui_pool[idx];
+        const uint16_t next = node->next;
+        bool superseded = false;
+        if (node->key)
+        {
+            for (uint32_t i = 0; i < seen && !superseded; ++i)
+                superseded = (pt_ui_seen_keys[i] == node->key);
+            if (!superseded)
+                pt_ui_seen_keys[seen++] = node->key;
+        }
+        if (superseded)
+        {
+            pt_ui_node_release((uint16_t)idx);
+            pt_ui_coalesced++;
+        }
+        else
+        {
+            pt_ui_batch[batch++] = (uint16_t)idx;
+        }
+        idx = next;
+    }
+
+    /* Run oldest first; free each node before the call so the callback can post again */
+    pt_ui_executed += batch;
+    while (batch > 0)
+    {
+        const uint16_t i = pt_ui_batch[--batch];
+        const pt_ui_fn_t fn = pt_ui_pool[i].fn;
+        void *arg = pt_ui_pool[i].arg;
+        pt_ui_node_release(i);
+        fn(arg);
+    }
+}
+
+/* ====================== LVGL runtime (tick source + task) ====================== */
+#ifdef CONFIG_PT_LVGL_TASK_PACING_VSYNC
+static void pt_lvgl_task(void *arg)
+{
+    (void)arg;
+    ESP_LOGI(TAG, "LVGL task started (VSYNC paced, divisor %u)", (unsigned)pt_vsync_divisor);
+    uint32_t last_vsync = pt_vsync_count;
+    while (true)
+    {
+        /* Timeout keeps LVGL alive should the panel ever stop reporting VSYNC */
+        uint32_t woke = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+        const uint32_t now = pt_vsync_count;
+        const uint32_t elapsed = now - last_vsync;
+        const uint32_t divisor = pt_vsync_divisor;
+        if (woke && elapsed < divisor)
+            continue;
+        if (elapsed >= 2 * divisor)
+            pt_missed_frames += elapsed / divisor - 1;
+        last_vsync = now;
+
+        PT_LVGL_SCOPE_LOCK()
+        {
+            pt_ui_queue_drain();
+            pt_lvgl_touch_process();
+            lv_timer_handler();
+        }
+#if defined(CONFIG_PT_LVGL_LOCK_PROFILER) && CONFIG_PT_LVGL_LOCK_PROFILER_LOG_PERIOD_S > 0
+        pt_lock_prof_periodic();
+#endif
+    }
+}
+#else
 static void pt_lvgl_task(void *arg)
 {
     (void)arg;
     ESP_LOGI(TAG, "LVGL task started");
-    uint32_t period = pdMS_TO_TICKS(0);
+    uint32_t period = 0;
     while (true)
     {
         PT_LVGL_SCOPE_LOCK()
         {
+            pt_ui_queue_drain();
+            pt_lvgl_touch_process();
             period = lv_timer_handler();
         }
-        vTaskDelay(period);
+#if defined(CONFIG_PT_LVGL_LOCK_PROFILER) && CONFIG_PT_LVGL_LOCK_PROFILER_LOG_PERIOD_S > 0
+        pt_lock_prof_periodic();
+#endif
+        /* A UI callback posted from this task does not notify it */
+        if (!pt_ui_queue_empty())
+            continue;
+        /* Nothing scheduled: sleep until touch, pt_display_schedule_ui() or an invalidation wakes us */
+        ulTaskNotifyTake(pdTRUE, (period == LV_NO_TIMER_READY) ? portMAX_DELAY : pdMS_TO_TICKS(period));
     }
 }
+#endif
 
 static esp_err_t pt_lvgl_start_runtime(void)
 {
     pt_display_ensure_lvgl_mutex();
 
-    if (pt_lvgl_tick == NULL)
+#ifdef CONFIG_PT_LVGL_TASK_PACING_VSYNC
+    pt_vsync_divisor = CONFIG_PT_LVGL_VSYNC_DIVISOR;
+    /* The task already gates renders on VSYNC; let LVGL refresh on every pass */
+    if (pt_disp && lv_display_get_refr_timer(pt_disp))
+        lv_timer_set_period(lv_display_get_refr_timer(pt_disp), 1);
+#endif
+
+    lv_tick_set_cb(pt_lvgl_tick_get_cb);
+    pt_ui_queue_init();
+    if (pt_disp)
     {
-        const esp_timer_create_args_t tick_args = {
-            .callback = &pt_lvgl_tick_cb,
-            .dispatch_method = ESP_TIMER_TASK,
-            .name = "lvgl_tick"};
-        ESP_RETURN_ON_ERROR(esp_timer_create(&tick_args, &pt_lvgl_tick), TAG, "timer_create");
-        ESP_RETURN_ON_ERROR(esp_timer_start_periodic(pt_lvgl_tick, 2000), TAG, "timer_start");
+        lv_display_add_event_cb(pt_disp, pt_lvgl_display_event_cb, LV_EVENT_INVALIDATE_AREA, NULL);
+        lv_display_add_event_cb(pt_disp, pt_lvgl_display_event_cb, LV_EVENT_REFR_READY, NULL);
+#if defined(CONFIG_PT_DISPLAY_STATS) || defined(CONFIG_PT_LVGL_TOUCH_FRAME_SYNC)
+        lv_display_add_event_cb(pt_disp, pt_lvgl_display_event_cb, LV_EVENT_REFR_START, NULL);
+#endif
+#ifdef CONFIG_PT_DISPLAY_STATS
+        lv_display_add_event_cb(pt_disp, pt_lvgl_display_event_cb, LV_EVENT_RENDER_START, NULL);
+        lv_display_add_event_cb(pt_disp, pt_lvgl_display_event_cb, LV_EVENT_RENDER_READY, NULL);
+        pt_stats.start_us = esp_timer_get_time();
+#endif
     }
     xTaskCreatePinnedToCoreWithCaps(pt_lvgl_task, "lvgl", CONFIG_PT_LVGL_TASK_STACK_SIZE * 1024, NULL, 5, &pt_task_handle_lvgl, 1, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
     return ESP_OK;
@@ -360,13 +1182,15 @@ esp_err_t pt_display_init(void)
     pt_backlight_init(5);
     pt_backlight_set(100);
 
+    PT_LVGL_render_method_t method = (PT_LVGL_render_method_t)CONFIG_PT_LVGL_RENDER_METHOD;
+
     /* Step 1: LCD panel (no LVGL yet) */
-    ESP_RETURN_ON_ERROR(pt_lcd_panel_init(), TAG, "panel_init");
+    ESP_RETURN_ON_ERROR(pt_lcd_panel_init(method), TAG, "panel_init");
 
     /* Step 2: LVGL core + display */
     lv_init();
-    PT_LVGL_render_method_t method = (PT_LVGL_render_method_t)CONFIG_PT_LVGL_RENDER_METHOD;
 
+    pt_render_method = method;
     ESP_RETURN_ON_ERROR(pt_lvgl_display_init(&pt_disp,
                                              method,
                                              LV_COLOR_FORMAT_RGB565,
@@ -374,10 +1198,11 @@ esp_err_t pt_display_init(void)
                                              pt_lcd_panel_handle),
                         TAG, "pt_lvgl_display_init");
 
-    lv_indev_t *indev = pt_lvgl_touch_init(pt_disp, 800, 480);
+    /* 0x0: map from the output range in the GT911 config block (tuned or factory) */
+    lv_indev_t *indev = pt_lvgl_touch_init(pt_disp, 0, 0);
     (void)indev;
 
-    /* Step 3: LVGL runtime (tick + task) */
+    /* Step 3: LVGL runtime (tick source + task) */
     ESP_RETURN_ON_ERROR(pt_lvgl_start_runtime(), TAG, "pt_lvgl_start_runtime");
 
     return ESP_OK;
@@ -389,12 +1214,218 @@ uint32_t pt_backlight_get(void)
 }
 
 void pt_display_schedule_ui(pt_ui_fn_t fn, void *arg)
+{
+    (void)pt_display_post_ui(fn, arg, 0);
+}
+
+bool pt_display_post_ui(pt_ui_fn_t fn, void *arg, uint32_t key)
 {
     if (!fn)
+        return false;
+    if (xPortInIsrContext())
+        return pt_display_post_ui_from_isr(fn, arg, key);
+    if (pt_ui_queue_post(fn, arg, key))
+        return true;
+
+    /* Pool exhausted: fall back to an LVGL async call (allocates a timer, no coalescing) */
+    static bool warned = false;
+    if (!warned)
+    {
+        ESP_LOGW(TAG, "UI queue full (%d nodes), falling back to lv_async_call", CONFIG_PT_DISPLAY_UI_QUEUE_SIZE);
+        warned = true;
+    }
+    lv_result_t res = LV_RESULT_INVALID;
+    PT_LVGL_SCOPE_LOCK()
+    {
+        res = lv_async_call(fn, arg);
+    }
+    pt_display_wake();
+    return res == LV_RESULT_OK;
+}
+
+bool pt_display_post_ui_from_isr(pt_ui_fn_t fn, void *arg, uint32_t key)
+{
+    if (!fn)
+        return false;
+    return pt_ui_queue_post(fn, arg, key);
+}
+
+void pt_display_get_ui_queue_stats(pt_display_ui_queue_stats_t *out)
+{
+    if (!out)
         return;
-    /* Run on LVGL thread */
-    lv_async_call(fn, arg);
+    out->posted = atomic_load(&pt_ui_posted);
+    out->executed = pt_ui_executed;
+    out->coalesced = pt_ui_coalesced;
+    out->pool_exhausted = atomic_load(&pt_ui_exhausted);
+    out->pool_size = CONFIG_PT_DISPLAY_UI_QUEUE_SIZE;
+}
+
+void pt_display_get_coalesce_stats(pt_display_coalesce_stats_t *out)
+{
+    if (out)
+        *out = pt_coalesce_stats;
 }
 
+esp_err_t pt_display_set_render_method(PT_LVGL_render_method_t method, int partial_lines, pt_display_buffer_info_t *out_info)
+{
+    if (!pt_disp)
+        return ESP_ERR_INVALID_STATE;
+    if (method < PT_LVGL_RENDER_FULL_1 || method > PT_LVGL_RENDER_DIRECT_2)
+        return ESP_ERR_INVALID_ARG;
+    if (method == PT_LVGL_RENDER_DIRECT_2 && pt_panel_num_fbs != 2)
+        return ESP_ERR_NOT_SUPPORTED; /* the panel framebuffers are fixed when the panel is created */
+    if (partial_lines <= 0)
+        partial_lines = CONFIG_PT_LVGL_RENDER_PARTIAL_BUFFER_LINES;
+    if (partial_lines > PT_LCD_V_RES)
+        partial_lines = PT_LCD_V_RES;
+
+    esp_err_t ret = ESP_OK;
+    pt_lvgl_lock(); /* the LVGL task only renders while holding the lock */
+    {
+#ifdef CONFIG_PT_LVGL_FLUSH_ASYNC
+        /* Let the flush task finish with the buffers we are about to replace */
+        const TickType_t start = xTaskGetTickCount();
+        while (atomic_load(&pt_flush_inflight))
+        {
+            if (xTaskGetTickCount() - start >= pdMS_TO_TICKS(PT_FLUSH_DRAIN_TIMEOUT_MS))
+            {
+                ESP_LOGE(TAG, "Flush still in flight after %d ms, keeping current buffers", PT_FLUSH_DRAIN_TIMEOUT_MS);
+                pt_lvgl_unlock();
+                return ESP_ERR_TIMEOUT;
+            }
+            vTaskDelay(1);
+        }
+#endif
+        /* Allocate and attach the new buffers first: until lv_display_set_buffers() succeeds LVGL
+           keeps rendering into the old ones, so they may only be freed afterwards */
+        void *old_bufs[2] = {pt_lvgl_bufs[0], pt_lvgl_bufs[1]};
+        void *old_fbs[2] = {pt_direct_fbs[0], pt_direct_fbs[1]};
+        pt_lvgl_bufs[0] = pt_lvgl_bufs[1] = NULL;
+        pt_direct_fbs[0] = pt_direct_fbs[1] = NULL;
+        if (pt_lvgl_setup_buffers(pt_disp, PT_LCD_H_RES, PT_LCD_V_RES, method, partial_lines))
+        {
+            for (int i = 0; i < 2; ++i)
+            {
+                if (old_bufs[i])
+                    heap_caps_free(old_bufs[i]);
+            }
+            pt_render_method = pt_buf_info.method;
+#ifdef CONFIG_PT_LVGL_FLUSH_ASYNC
+            if (!pt_direct_fbs[0] && pt_lvgl_flush_async_init() != ESP_OK)
+                ESP_LOGW(TAG, "Async flush unavailable, flushing synchronously");
+#endif
+            /* New buffers hold nothing yet (and DIRECT_2 must resync both framebuffers) */
+            lv_obj_invalidate(lv_display_get_screen_active(pt_disp));
+        }
+        else
+        {
+            /* The old buffers are still attached to LVGL: keep them */
+            ESP_LOGW(TAG, "Render method %d unavailable, keeping %d", (int)method, (int)pt_buf_info.method);
+            pt_lvgl_bufs[0] = old_bufs[0];
+            pt_lvgl_bufs[1] = old_bufs[1];
+            pt_direct_fbs[0] = old_fbs[0];
+            pt_direct_fbs[1] = old_fbs[1];
+            ret = ESP_ERR_NO_MEM;
+        }
+        if (out_info)
+            *out_info = pt_buf_info;
+    }
+    pt_lvgl_unlock();
+    pt_display_wake();
+    return ret;
+}
+
+void pt_display_get_buffer_info(pt_display_buffer_info_t *out)
+{
+    if (out)
+        *out = pt_buf_info;
+}
+
+esp_err_t pt_display_get_stats(pt_display_stats_t *out, bool reset)
+{
+    if (!out)
+        return ESP_ERR_INVALID_ARG;
+#ifdef CONFIG_PT_DISPLAY_STATS
+    /* Copy under the spinlock, derive percentiles outside of it */
+    pt_stats_window_t w;
+    const int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&pt_stats_mux);
+    w = pt_stats;
+    if (reset)
+    {
+        memset(&pt_stats, 0, sizeof(pt_stats));
+        pt_stats.start_us = now;
+    }
+    portEXIT_CRITICAL(&pt_stats_mux);
+
+    out->window_ms = (uint32_t)((now - w.start_us) / 1000);
+    out->frames = w.frames;
+    out->render_time_us = w.render_us;
+    out->flush_time_us = w.flush_us;
+    out->flush_count = w.flush_count;
+    out->bytes_pushed = w.bytes_pushed;
+    out->lock_max_hold_us = w.lock_max_hold_us;
+    out->stack_hwm_bytes = pt_task_handle_lvgl ? (uint32_t)uxTaskGetStackHighWaterMark(pt_task_handle_lvgl) : 0;
+    out->frame_time_p50_us = pt_stats_percentile_us(w.frame_hist, w.frames, w.frame_max_us, 50);
+    out->frame_time_p95_us = pt_stats_percentile_us(w.frame_hist, w.frames, w.frame_max_us, 95);
+    out->frame_time_p99_us = pt_stats_percentile_us(w.frame_hist, w.frames, w.frame_max_us, 99);
+    out->frame_time_max_us = w.frame_max_us;
+    out->input_frames = w.input_frames;
+    out->input_latency_p50_us = pt_stats_percentile_us(w.input_hist, w.input_frames, w.input_max_us, 50);
+    out->input_latency_p95_us = pt_stats_percentile_us(w.input_hist, w.input_frames, w.input_max_us, 95);
+    out->input_latency_p99_us = pt_stats_percentile_us(w.input_hist, w.input_frames, w.input_max_us, 99);
+    out->input_latency_max_us = w.input_max_us;
+    out->vsync_timeouts = w.vsync_timeouts;
+    return ESP_OK;
+#else
+    (void)reset;
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+void pt_display_note_input(int64_t timestamp_us)
+{
+#ifdef CONFIG_PT_DISPLAY_STATS
+    /* LVGL task only (input read callbacks): no locking needed */
+    if (timestamp_us > pt_stats_input_newest_us)
+        pt_stats_input_newest_us = timestamp_us;
+#else
+    (void)timestamp_us;
+#endif
+}
+
+void pt_display_wake(void)
+{
+    TaskHandle_t task = pt_task_handle_lvgl;
+    if (!task)
+        return;
+    if (xPortInIsrContext())
+    {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(task, &woken);
+        portYIELD_FROM_ISR(woken);
+        return;
+    }
+    /* The LVGL task re-evaluates its timers after every pass anyway */
+    if (xTaskGetCurrentTaskHandle() != task)
+        xTaskNotifyGive(task);
+}
+
+esp_err_t pt_display_set_vsync_divisor(uint8_t divisor)
+{
+#ifdef CONFIG_PT_LVGL_TASK_PACING_VSYNC
+    if (divisor < 1 || divisor > 6)
+        return ESP_ERR_INVALID_ARG;
+    pt_vsync_divisor = divisor;
+    return ESP_OK;
+#else
+    (void)divisor;
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+uint32_t pt_display_get_missed_frames(void) { return pt_missed_frames; }
+
 lv_display_t *pt_get_display(void) { return pt_disp; }
 esp_lcd_panel_handle_t pt_get_panel(void) { return pt_lcd_panel_handle; }
@@ -0,0 +1,1089 @@
+#include "pandatouch_image_cache.h"
+#include <string.h>
+#include <strings.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <sys/stat.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "sdkconfig.h"
+
+#include "lvgl.h"
+#include "pandatouch_display.h"
+#include "pandatouch_msc.h"
+
+#if CONFIG_PT_IMAGE_CACHE
+#include "draw/lv_image_decoder_private.h"
+#include "libs/lodepng/lodepng.h"
+#if LV_USE_TJPGD
+#include "libs/tjpgd/tjpgd.h"
+#endif
+
+/* --------- Logging --------- */
+static const char *TAG = "PandaTouch::ImageCache";
+
+/* --------- Config --------- */
+#define PT_IMG_TASK_STACK 6144
+#define PT_IMG_TASK_PRIO 3
+#define PT_IMG_CAPS (MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT)
+#define PT_IMG_UI_KEY 0x50494D43u /* 'PIMC': coalescing key of the release job */
+#define PT_IMG_JPEG_POOL 4096     /* tjpgd work area */
+#ifdef CONFIG_PT_ASSET_CACHE
+#define PT_ASSET_DIR PT_USB_MOUNT_PATH "/" CONFIG_PT_ASSET_CACHE_DIR
+#endif
+
+/* --------- Entries --------- */
+/* LRU list, head = most recently used. Lookups scan it: a UI holds tens of images, not thousands. */
+typedef struct pt_img_entry
+{
+    struct pt_img_entry *prev, *next;
+    uint32_t hash;
+    off_t fsize;
+    time_t mtime;
+    size_t bytes;
+    lv_draw_buf_t draw_buf; /* handed to LVGL; pixels owned by the cache */
+    char path[];
+} pt_img_entry_t;
+
+static SemaphoreHandle_t pt_img_mutex = NULL;
+static TaskHandle_t pt_img_task_handle = NULL;
+static pt_img_entry_t *pt_img_head = NULL, *pt_img_tail = NULL;
+/* Evicted entries: LVGL may still reference them until lv_image_cache_drop() runs on its thread */
+static pt_img_entry_t *pt_img_graveyard = NULL;
+static size_t pt_img_bytes = 0;
+static size_t pt_img_budget = 0;
+static pt_image_cache_stats_t pt_img_stats;
+
+/* What a load is for */
+typedef enum
+{
+    PT_IMG_JOB_PREFETCH,   /* into the cache: converted file if there is one, else decode (and convert) */
+    PT_IMG_JOB_CONVERT,    /* only write the converted file; the pixels are not kept */
+    PT_IMG_JOB_ASSET_ONLY, /* into the cache, but only from an existing converted file (LVGL thread) */
+} pt_img_job_t;
+
+/* Pending jobs, in priority order (prefetches first) */
+typedef struct
+{
+    char *path;
+    pt_img_job_t job;
+} pt_img_pending_t;
+static pt_img_pending_t pt_img_pending[CONFIG_PT_IMAGE_CACHE_PREFETCH_MAX];
+static size_t pt_img_pending_count = 0;
+
+/* Fit box: images larger than the display are scaled down to it (0: keep the size) */
+static uint16_t pt_img_fit_w = 0, pt_img_fit_h = 0;
+
+#define PT_IMG_LOCK() xSemaphoreTake(pt_img_mutex, portMAX_DELAY)
+#define PT_IMG_UNLOCK() xSemaphoreGive(pt_img_mutex)
+
+static uint32_t pt_img_hash(const char *s)
+{
+    uint32_t h = 2166136261u;
+    while (*s)
+        h = (h ^ (uint8_t)*s++) * 16777619u;
+    return h;
+}
+
+static bool pt_img_has_ext(const char *path, const char *ext)
+{
+    const size_t n = strlen(path), e = strlen(ext);
+    return n >= e && strcasecmp(path + n - e, ext) == 0;
+}
+
+static bool pt_img_is_jpeg(const char *path)
+{
+#if LV_USE_TJPGD
+    return pt_img_has_ext(path, ".jpg") || pt_img_has_ext(path, ".jpeg");
+#else
+    (void)path;
+    return false;
+#endif
+}
+
+/* Files this module can decode */
+static bool pt_img_is_decodable(const char *path)
+{
+    return pt_img_has_ext(path, ".png") || pt_img_is_jpeg(path);
+}
+
+/* Caller holds the mutex */
+static pt_img_entry_t *pt_img_find(const char *path)
+{
+    const uint32_t h = pt_img_hash(path);
+    for (pt_img_entry_t *e = pt_img_head; e; e = e->next)
+    {
+        if (e->hash == h && strcmp(e->path, path) == 0)
+            return e;
+    }
+    return NULL;
+}
+
+static void pt_img_unlink(pt_img_entry_t *e)
+{
+    if (e->prev)
+        e->prev->next = e->next;
+    else
+        pt_img_head = e->next;
+    if (e->next)
+        e->next->prev = e->prev;
+    else
+        pt_img_tail = e->prev;
+    e->prev = e->next = NULL;
+}
+
+static void pt_img_push_front(pt_img_entry_t *e)
+{
+    e->prev = NULL;
+    e->next = pt_img_head;
+    if (pt_img_head)
+        pt_img_head->prev = e;
+    pt_img_head = e;
+    if (!pt_img_tail)
+        pt_img_tail = e;
+}
+
+static void pt_img_touch(pt_img_entry_t *e)
+{
+    if (pt_img_head != e)
+    {
+        pt_img_unlink(e);
+        pt_img_push_front(e);
+    }
+}
+
+/* Caller holds the mutex */
+static void pt_img_retire(pt_img_entry_t *e)
+{
+    pt_img_unlink(e);
+    pt_img_bytes -= e->bytes;
+    pt_img_stats.entries--;
+    e->next = pt_img_graveyard;
+    pt_img_graveyard = e;
+}
+
+static void pt_img_free(pt_img_entry_t *e)
+{
+    heap_caps_free(e->draw_buf.data);
+    heap_caps_free(e);
+}
+
+/* LVGL thread: make LVGL forget the retired entries, then free them */
+static void pt_img_release_ui(void *arg)
+{
+    (void)arg;
+    PT_IMG_LOCK();
+    pt_img_entry_t *list = pt_img_graveyard;
+    pt_img_graveyard = NULL;
+    PT_IMG_UNLOCK();
+    while (list)
+    {
+        pt_img_entry_t *next = list->next;
+        lv_image_cache_drop(list->path);
+        pt_img_free(list);
+        list = next;
+    }
+}
+
+static void pt_img_schedule_release(void)
+{
+    /* If the UI queue is full the graveyard stays; the next retirement posts again */
+    (void)pt_display_post_ui(pt_img_release_ui, NULL, PT_IMG_UI_KEY);
+}
+
+/* --------- Decode (any task but LVGL's) --------- */
+static esp_err_t pt_img_read_file(const char *path, size_t len, uint8_t **out)
+{
+    FILE *fp = fopen(path, "rb");
+    if (!fp)
+        return ESP_ERR_NOT_FOUND;
+    uint8_t *buf = heap_caps_malloc(len ? len : 1, PT_IMG_CAPS);
+    if (!buf)
+    {
+        fclose(fp);
+        return ESP_ERR_NO_MEM;
+    }
+    /* One read of the whole file straight into PSRAM */
+    setvbuf(fp, NULL, _IONBF, 0);
+    const size_t got = fread(buf, 1, len, fp);
+    fclose(fp);
+    if (got != len)
+    {
+        heap_caps_free(buf);
+        return ESP_FAIL;
+    }
+    *out = buf;
+    return ESP_OK;
+}
+
+#if LV_USE_TJPGD
+typedef struct
+{
+    const uint8_t *src;
+    size_t len, pos;
+    uint8_t *rgba; /* output, w x h x 4 */
+    uint32_t w;
+} pt_img_jpeg_io_t;
+
+static size_t pt_img_jpeg_in(JDEC *jd, uint8_t *buf, size_t n)
+{
+    pt_img_jpeg_io_t *io = (pt_img_jpeg_io_t *)jd->device;
+    if (n > io->len - io->pos)
+        n = io->len - io->pos;
+    if (buf)
+        memcpy(buf, io->src + io->pos, n);
+    io->pos += n;
+    return n;
+}
+
+static int pt_img_jpeg_out(JDEC *jd, void *bitmap, JRECT *rect)
+{
+    pt_img_jpeg_io_t *io = (pt_img_jpeg_io_t *)jd->device;
+    const uint8_t *src = (const uint8_t *)bitmap;
+    for (uint32_t y = rect->top; y <= rect->bottom; y++)
+    {
+        uint8_t *dst = io->rgba + ((size_t)y * io->w + rect->left) * 4;
+        for (uint32_t x = rect->left; x <= rect->right; x++, dst += 4)
+        {
+#if JD_FORMAT == 1
+            const uint16_t c = *(const uint16_t *)src;
+            src += 2;
+            dst[0] = (uint8_t)((c >> 8) & 0xF8);
+            dst[1] = (uint8_t)((c >> 3) & 0xFC);
+            dst[2] = (uint8_t)(c << 3);
+#else
+            dst[0] = src[0];
+            dst[1] = src[1];
+            dst[2] = src[2];
+            src += 3;
+#endif
+            dst[3] = 0xFF;
+        }
+    }
+    return 1;
+}
+
+/* Decode with the largest tjpgd scale (1/2 .. 1/8) that still covers the fit box */
+static esp_err_t pt_img_decode_jpeg(const uint8_t *data, size_t len, unsigned *w, unsigned *h, uint8_t **rgba)
+{
+    void *pool = heap_caps_malloc(PT_IMG_JPEG_POOL, MALLOC_CAP_8BIT);
+    if (!pool)
+        return ESP_ERR_NO_MEM;
+    pt_img_jpeg_io_t io = {.src = data, .len = len};
+    JDEC jd;
+    esp_err_t err = ESP_FAIL;
+    if (jd_prepare(&jd, pt_img_jpeg_in, pool, PT_IMG_JPEG_POOL, &io) == JDR_OK)
+    {
+        uint8_t scale = 0;
+        while (pt_img_fit_w && scale < 3 &&
+               (jd.width >> (scale + 1)) >= pt_img_fit_w && (jd.height >> (scale + 1)) >= pt_img_fit_h)
+            scale++;
+        /* tjpgd rounds partial MCUs up */
+        io.w = (jd.width + (1u << scale) - 1) >> scale;
+        const uint32_t oh = (jd.height + (1u << scale) - 1) >> scale;
+        io.rgba = lv_malloc((size_t)io.w * oh * 4);
+        if (!io.rgba)
+            err = ESP_ERR_NO_MEM;
+        else if (jd_decomp(&jd, pt_img_jpeg_out, scale) == JDR_OK)
+        {
+            *w = io.w;
+            *h = oh;
+            *rgba = io.rgba;
+            err = ESP_OK;
+        }
+        else
+            lv_free(io.rgba);
+    }
+    heap_caps_free(pool);
+    return err;
+}
+#endif
+
+/* Scale down in place to fit the fit box, averaging each source box (alpha-weighted colour).
+   Destination pixel i never lies past the first source pixel it reads, so one buffer does. */
+static void pt_img_fit(uint8_t *rgba, unsigned *w, unsigned *h)
+{
+    const unsigned sw = *w, sh = *h;
+    if (!pt_img_fit_w || (sw <= pt_img_fit_w && sh <= pt_img_fit_h))
+        return;
+    unsigned dw, dh;
+    if ((uint64_t)sw * pt_img_fit_h > (uint64_t)sh * pt_img_fit_w)
+    {
+        dw = pt_img_fit_w;
+        dh = (unsigned)((uint64_t)sh * pt_img_fit_w / sw);
+    }
+    else
+    {
+        dh = pt_img_fit_h;
+        dw = (unsigned)((uint64_t)sw * pt_img_fit_h / sh);
+    }
+    if (dw == 0)
+        dw = 1;
+    if (dh == 0)
+        dh = 1;
+
+    for (unsigned y = 0; y < dh; y++)
+    {
+        const unsigned y0 = (unsigned)((uint64_t)y * sh / dh), y1 = (unsigned)((uint64_t)(y + 1) * sh / dh);
+        for (unsigned x = 0; x < dw; x++)
+        {
+            const unsigned x0 = (unsigned)((uint64_t)x * sw / dw), x1 = (unsigned)((uint64_t)(x + 1) * sw / dw);
+            uint32_t r = 0, g = 0, b = 0, a = 0, n = 0;
+            for (unsigned yy = y0; yy < y1; yy++)
+            {
+                const uint8_t *p = rgba + ((size_t)yy * sw + x0) * 4;
+                for (unsigned xx = x0; xx < x1; xx++, p += 4)
+                {
+                    r += p[0] * p[3];
+                    g += p[1] * p[3];
+                    b += p[2] * p[3];
+                    a += p[3];
+                    n++;
+                }
+            }
+            uint8_t *d = rgba + ((size_t)y * dw + x) * 4;
+            d[0] = a ? (uint8_t)(r / a) : 0;
+            d[1] = a ? (uint8_t)(g / a) : 0;
+            d[2] = a ? (uint8_t)(b / a) : 0;
+            d[3] = (uint8_t)(a / n);
+        }
+    }
+    *w = dw;
+    *h = dh;
+}
+
+static inline uint16_t pt_img_rgb565(const uint8_t *p)
+{
+    return (uint16_t)(((p[0] & 0xF8) << 8) | ((p[1] & 0xFC) << 3) | (p[2] >> 3));
+}
+
+static pt_img_entry_t *pt_img_entry_new(const char *path, const struct stat *st)
+{
+    const size_t plen = strlen(path) + 1;
+    pt_img_entry_t *e = heap_caps_calloc(1, sizeof(*e) + plen, MALLOC_CAP_8BIT);
+    if (e)
+    {
+        memcpy(e->path, path, plen);
+        e->hash = pt_img_hash(path);
+        e->fsize = st->st_size;
+        e->mtime = st->st_mtime;
+    }
+    return e;
+}
+
+/* Pixel data size of a panel-ready image: RGB565 plane, plus an A8 plane for RGB565A8 */
+static size_t pt_img_data_size(lv_color_format_t cf, uint32_t stride, uint32_t h)
+{
+    size_t bytes = (size_t)stride * h;
+    if (cf == LV_COLOR_FORMAT_RGB565A8)
+        bytes += (size_t)(stride / 2) * h;
+    return bytes;
+}
+
+static esp_err_t pt_img_decode(const char *path, const struct stat *st, pt_img_entry_t **out)
+{
+    uint8_t *file = NULL;
+    esp_err_t err = pt_img_read_file(path, (size_t)st->st_size, &file);
+    if (err != ESP_OK)
+        return err;
+
+    unsigned char *rgba = NULL;
+    unsigned w = 0, h = 0;
+#if LV_USE_TJPGD
+    if (pt_img_is_jpeg(path))
+    {
+        err = pt_img_decode_jpeg(file, (size_t)st->st_size, &w, &h, &rgba);
+        heap_caps_free(file);
+        if (err != ESP_OK)
+        {
+            ESP_LOGW(TAG, "%s: JPEG decode failed", path);
+            return err;
+        }
+    }
+    else
+#endif
+    {
+        const unsigned lerr = lodepng_decode32(&rgba, &w, &h, file, (size_t)st->st_size);
+        heap_caps_free(file);
+        if (lerr)
+        {
+            ESP_LOGW(TAG, "%s: %s", path, lodepng_error_text(lerr));
+            return ESP_FAIL;
+        }
+    }
+    if (w == 0 || h == 0 || w > 0xFFFF || h > 0xFFFF)
+    {
+        lv_free(rgba);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    pt_img_fit(rgba, &w, &h);
+
+    /* Panel format: RGB565, plus a separate alpha plane (RGB565A8) only if the image needs one */
+    const size_t px = (size_t)w * h;
+    bool opaque = true;
+    for (size_t i = 0; i < px && opaque; i++)
+        opaque = rgba[i * 4 + 3] == 0xFF;
+    const lv_color_format_t cf = opaque ? LV_COLOR_FORMAT_RGB565 : LV_COLOR_FORMAT_RGB565A8;
+    const uint32_t stride = lv_draw_buf_width_to_stride(w, cf);
+    const size_t bytes = pt_img_data_size(cf, stride, h);
+    if (bytes > pt_img_budget)
+    {
+        ESP_LOGW(TAG, "%s: %u x %u does not fit the %u byte budget", path, w, h, (unsigned)pt_img_budget);
+        lv_free(rgba);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    pt_img_entry_t *e = pt_img_entry_new(path, st);
+    uint8_t *data = heap_caps_aligned_alloc(LV_DRAW_BUF_ALIGN, bytes, PT_IMG_CAPS);
+    if (!e || !data)
+    {
+        heap_caps_free(e);
+        heap_caps_free(data);
+        lv_free(rgba);
+        return ESP_ERR_NO_MEM;
+    }
+
+    uint8_t *alpha = data + (size_t)stride * h;
+    for (uint32_t y = 0; y < h; y++)
+    {
+        const uint8_t *src = rgba + (size_t)y * w * 4;
+        uint16_t *dst = (uint16_t *)(data + (size_t)y * stride);
+        uint8_t *a = alpha + (size_t)y * (stride / 2);
+        for (uint32_t x = 0; x < w; x++, src += 4)
+        {
+            dst[x] = pt_img_rgb565(src);
+            if (!opaque)
+                a[x] = src[3];
+        }
+    }
+    lv_free(rgba);
+
+    e->bytes = bytes;
+    lv_draw_buf_init(&e->draw_buf, w, h, cf, stride, data, bytes);
+    *out = e;
+    return ESP_OK;
+}
+
+/* --------- Converted files on the stick (LVGL binary image format) --------- */
+#ifdef CONFIG_PT_ASSET_CACHE
+/* "<dir>/<path hash>_<size>_<mtime>_<fit w>x<fit h>.bin": a changed source or display size
+   gives a new name, so validating a converted file is a single stat(). Only sources on the
+   stick (outside the cache directory) are converted. */
+static bool pt_asset_path(const char *src, const struct stat *st, char *out, size_t len)
+{
+    const size_t root = strlen(PT_USB_MOUNT_PATH);
+    if (strncmp(src, PT_USB_MOUNT_PATH "/", root + 1) != 0 ||
+        strncmp(src, PT_ASSET_DIR "/", strlen(PT_ASSET_DIR) + 1) == 0 || !pt_img_is_decodable(src))
+        return false;
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (const unsigned char *c = (const unsigned char *)src; *c; c++)
+        h = (h ^ *c) * 0x100000001b3ULL;
+    const int n = snprintf(out, len, PT_ASSET_DIR "/%016" PRIx64 "_%" PRIx32 "_%" PRIx32 "_%ux%u.bin", h,
+                           (uint32_t)st->st_size, (uint32_t)st->st_mtime, pt_img_fit_w, pt_img_fit_h);
+    return n > 0 && (size_t)n < len;
+}
+
+/* Remove older conversions of the same source (other size/mtime or fit box): they share the
+   "<path hash>_" prefix of `bin` and would otherwise pile up on the stick */
+static void pt_asset_remove_stale(const char *bin)
+{
+    const char *name = strrchr(bin, '/') + 1;
+    const size_t prefix = 17; /* 16 hex digits and '_' */
+    pt_usb_dir_list_t *list = pt_usb_list_dir_ex(PT_ASSET_DIR, 0, NULL);
+    if (!list)
+        return;
+    for (size_t i = 0; i < list->count; i++)
+    {
+        const pt_usb_dir_entry_t *ent = &list->entries[i];
+        if (!ent->is_dir && strncmp(ent->name, name, prefix) == 0 && strcmp(ent->name, name) != 0)
+        {
+            if (remove(ent->path) == 0)
+                ESP_LOGD(TAG, "removed stale %s", ent->path);
+        }
+    }
+    pt_usb_dir_list_free(list);
+}
+
+static esp_err_t pt_asset_write(const char *bin, const pt_img_entry_t *e)
+{
+    char tmp[160];
+    const int n = snprintf(tmp, sizeof(tmp), "%s.tmp", bin);
+    if (n < 0 || (size_t)n >= sizeof(tmp))
+        return ESP_ERR_INVALID_SIZE; /* writing to `bin` directly would not be atomic */
+    if (mkdir(PT_ASSET_DIR, 0777) != 0 && errno != EEXIST)
+        return ESP_FAIL;
+    FILE *fp = fopen(tmp, "wb");
+    if (!fp)
+        return ESP_FAIL;
+    setvbuf(fp, NULL, _IONBF, 0);
+    lv_image_header_t hdr = e->draw_buf.header;
+    hdr.magic = LV_IMAGE_HEADER_MAGIC;
+    hdr.flags = 0;
+    bool ok = fwrite(&hdr, sizeof(hdr), 1, fp) == 1 &&
+              fwrite(e->draw_buf.data, 1, e->bytes, fp) == e->bytes;
+    ok = (fclose(fp) == 0) && ok;
+    /* Written under a temporary name, so a pulled stick never leaves a valid-looking half file */
+    if (!ok || rename(tmp, bin) != 0)
+    {
+        remove(tmp);
+        return ESP_FAIL;
+    }
+    pt_asset_remove_stale(bin);
+    return ESP_OK;
+}
+
+static esp_err_t pt_asset_read(const char *bin, const char *path, const struct stat *src_st, pt_img_entry_t **out)
+{
+    FILE *fp = fopen(bin, "rb");
+    if (!fp)
+        return ESP_ERR_NOT_FOUND;
+    setvbuf(fp, NULL, _IONBF, 0);
+    lv_image_header_t hdr;
+    struct stat st;
+    esp_err_t err = ESP_ERR_INVALID_RESPONSE;
+    uint8_t *data = NULL;
+    pt_img_entry_t *e = NULL;
+    if (fread(&hdr, sizeof(hdr), 1, fp) == 1 && fstat(fileno(fp), &st) == 0 && hdr.magic == LV_IMAGE_HEADER_MAGIC &&
+        (hdr.cf == LV_COLOR_FORMAT_RGB565 || hdr.cf == LV_COLOR_FORMAT_RGB565A8) && hdr.w && hdr.h)
+    {
+        /* Never trust the stride on disk: it sizes the buffer and every row LVGL reads */
+        const size_t bytes = pt_img_data_size(hdr.cf, hdr.stride, hdr.h);
+        if (hdr.stride != lv_draw_buf_width_to_stride(hdr.w, hdr.cf))
+            err = ESP_ERR_INVALID_SIZE;
+        else if ((size_t)st.st_size != sizeof(hdr) + bytes)
+            err = ESP_ERR_INVALID_SIZE;
+        else if (bytes > pt_img_budget)
+            err = ESP_ERR_INVALID_SIZE;
+        else if (!(e = pt_img_entry_new(path, src_st)) ||
+                 !(data = heap_caps_aligned_alloc(LV_DRAW_BUF_ALIGN, bytes, PT_IMG_CAPS)))
+            err = ESP_ERR_NO_MEM;
+        else if (fread(data, 1, bytes, fp) == bytes)
+        {
+            e->bytes = bytes;
+            lv_draw_buf_init(&e->draw_buf, hdr.w, hdr.h, hdr.cf, hdr.stride, data, bytes);
+            *out = e;
+            err = ESP_OK;
+        }
+        else
+            err = ESP_FAIL;
+    }
+    fclose(fp);
+    if (err != ESP_OK)
+    {
+        heap_caps_free(data);
+        heap_caps_free(e);
+    }
+    return err;
+}
+#endif /* CONFIG_PT_ASSET_CACHE */
+
+/* Insert, evicting from the LRU tail to stay within the budget */
+static void pt_img_insert(pt_img_entry_t *e)
+{
+    bool retired = false;
+    PT_IMG_LOCK();
+    pt_img_entry_t *old = pt_img_find(e->path);
+    if (old)
+    {
+        pt_img_retire(old); /* stale version (or a concurrent decode of the same file) */
+        retired = true;
+    }
+    while (pt_img_tail && pt_img_bytes + e->bytes > pt_img_budget)
+    {
+        pt_img_retire(pt_img_tail);
+        pt_img_stats.evictions++;
+        retired = true;
+    }
+    pt_img_push_front(e);
+    pt_img_bytes += e->bytes;
+    pt_img_stats.entries++;
+    PT_IMG_UNLOCK();
+    if (retired)
+        pt_img_schedule_release();
+}
+
+static esp_err_t pt_img_load(const char *path, pt_img_job_t job)
+{
+    struct stat st;
+    if (stat(path, &st) != 0)
+        return ESP_ERR_NOT_FOUND;
+
+    pt_img_entry_t *e = NULL;
+    if (job != PT_IMG_JOB_CONVERT)
+    {
+        PT_IMG_LOCK();
+        e = pt_img_find(path);
+        const bool fresh = e && e->fsize == st.st_size && e->mtime == st.st_mtime;
+        if (fresh)
+            pt_img_touch(e);
+        PT_IMG_UNLOCK();
+        if (fresh)
+            return ESP_OK;
+    }
+
+#ifdef CONFIG_PT_ASSET_CACHE
+    /* A converted copy turns the load into one sequential read with no decode */
+    char bin[160];
+    const bool convertible = pt_asset_path(path, &st, bin, sizeof(bin));
+    struct stat bin_st;
+    if (convertible && stat(bin, &bin_st) == 0)
+    {
+        if (job == PT_IMG_JOB_CONVERT)
+            return ESP_OK;
+        if (pt_asset_read(bin, path, &st, &e) == ESP_OK)
+        {
+            pt_img_insert(e);
+            PT_IMG_LOCK();
+            pt_img_stats.assets_loaded++;
+            PT_IMG_UNLOCK();
+            return ESP_OK;
+        }
+        ESP_LOGW(TAG, "%s: unreadable, converting %s again", bin, path);
+    }
+#endif
+    if (job == PT_IMG_JOB_ASSET_ONLY)
+        return ESP_ERR_NOT_FOUND;
+
+    const int64_t t0 = esp_timer_get_time();
+    esp_err_t err = pt_img_decode(path, &st, &e);
+    const uint32_t dt = (uint32_t)(esp_timer_get_time() - t0);
+    if (err != ESP_OK)
+    {
+        PT_IMG_LOCK();
+        pt_img_stats.decode_errors++;
+        PT_IMG_UNLOCK();
+        return err;
+    }
+    ESP_LOGD(TAG, "decoded %s in %" PRIu32 " us", path, dt);
+
+    bool converted = false;
+#ifdef CONFIG_PT_ASSET_CACHE
+    if (convertible)
+    {
+        converted = pt_asset_write(bin, e) == ESP_OK;
+        if (!converted)
+            ESP_LOGW(TAG, "%s: could not write %s", path, bin);
+    }
+#endif
+    PT_IMG_LOCK();
+    pt_img_stats.decodes++;
+    pt_img_stats.assets_written += converted;
+    if (dt > pt_img_stats.max_decode_us)
+        pt_img_stats.max_decode_us = dt;
+    PT_IMG_UNLOCK();
+
+    if (job == PT_IMG_JOB_CONVERT)
+        pt_img_free(e);
+    else
+        pt_img_insert(e);
+    return ESP_OK;
+}
+
+/* --------- Prefetch worker --------- */
+static bool pt_img_pop(pt_img_pending_t *out)
+{
+    bool any = false;
+    PT_IMG_LOCK();
+    if (pt_img_pending_count)
+    {
+        *out = pt_img_pending[0];
+        memmove(&pt_img_pending[0], &pt_img_pending[1], --pt_img_pending_count * sizeof(pt_img_pending[0]));
+        any = true;
+    }
+    PT_IMG_UNLOCK();
+    return any;
+}
+
+static void pt_img_task(void *arg)
+{
+    (void)arg;
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        pt_img_pending_t job;
+        while (pt_img_pop(&job))
+        {
+            (void)pt_img_load(job.path, job.job);
+            free(job.path);
+        }
+    }
+}
+
+#ifdef CONFIG_PT_ASSET_CACHE
+/* Queue a background conversion behind the prefetches, unless already queued or full */
+static void pt_img_queue_convert(const char *path)
+{
+    char *dup = NULL;
+    PT_IMG_LOCK();
+    bool queued = pt_img_pending_count == CONFIG_PT_IMAGE_CACHE_PREFETCH_MAX;
+    for (size_t i = 0; i < pt_img_pending_count && !queued; i++)
+        queued = strcmp(pt_img_pending[i].path, path) == 0;
+    PT_IMG_UNLOCK();
+    if (queued || !(dup = strdup(path)))
+        return;
+    PT_IMG_LOCK();
+    if (pt_img_pending_count < CONFIG_PT_IMAGE_CACHE_PREFETCH_MAX)
+    {
+        pt_img_pending[pt_img_pending_count++] = (pt_img_pending_t){.path = dup, .job = PT_IMG_JOB_CONVERT};
+        dup = NULL;
+    }
+    PT_IMG_UNLOCK();
+    free(dup);
+    xTaskNotifyGive(pt_img_task_handle);
+}
+#endif
+
+/* --------- LVGL decoder --------- */
+/* Registered last, so LVGL asks it before the built-in decoders. It claims paths it holds,
+   and paths with a converted file on the stick (loaded here: a plain read, no decode);
+   everything else falls through to the regular (synchronous) decoders, and gets queued
+   for conversion so the next visit is fast. */
+static lv_result_t pt_img_info_cb(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc, lv_image_header_t *header)
+{
+    (void)decoder;
+    if (dsc->src_type != LV_IMAGE_SRC_FILE)
+        return LV_RESULT_INVALID;
+    const char *path = (const char *)dsc->src;
+
+    PT_IMG_LOCK();
+    bool known = pt_img_find(path) != NULL;
+    PT_IMG_UNLOCK();
+    if (!known && pt_img_is_decodable(path))
+    {
+#ifdef CONFIG_PT_ASSET_CACHE
+        known = pt_img_load(path, PT_IMG_JOB_ASSET_ONLY) == ESP_OK;
+        if (!known)
+            pt_img_queue_convert(path);
+#endif
+        if (!known)
+        {
+            PT_IMG_LOCK();
+            pt_img_stats.misses++;
+            PT_IMG_UNLOCK();
+        }
+    }
+    if (!known)
+        return LV_RESULT_INVALID;
+
+    /* Validate against the file (stat outside the lock; it may touch the USB stick) */
+    struct stat st;
+    if (stat(path, &st) != 0)
+        return LV_RESULT_INVALID;
+    lv_result_t res = LV_RESULT_INVALID;
+    PT_IMG_LOCK();
+    pt_img_entry_t *e = pt_img_find(path);
+    if (e && e->fsize == st.st_size && e->mtime == st.st_mtime)
+    {
+        *header = e->draw_buf.header;
+        res = LV_RESULT_OK;
+    }
+    else
+    {
+        pt_img_stats.misses++;
+    }
+    PT_IMG_UNLOCK();
+    return res;
+}
+
+static lv_result_t pt_img_open_cb(lv_image_decoder_t *decoder, lv_image_decoder_dsc_t *dsc)
+{
+    PT_IMG_LOCK();
+    pt_img_entry_t *e = pt_img_find((const char *)dsc->src);
+    if (e)
+    {
+        pt_img_touch(e);
+        pt_img_stats.hits++;
+        dsc->decoded = &e->draw_buf;
+    }
+    PT_IMG_UNLOCK();
+    if (!e)
+        return LV_RESULT_INVALID;
+
+    /* Evicted entries are only freed by pt_img_release_ui() on this thread, which drops them
+       from LVGL's cache first; so the pointer stays valid for as long as LVGL can see it.
+       The draw buffer is not flagged ALLOCATED, so LVGL never frees it itself. */
+    if (!dsc->args.no_cache && lv_image_cache_is_enabled())
+    {
+        lv_image_cache_data_t search_key = {0};
+        search_key.src_type = dsc->src_type;
+        search_key.src = dsc->src;
+        search_key.slot.size = dsc->decoded->data_size;
+        dsc->cache_entry = lv_image_decoder_add_to_cache(decoder, &search_key, dsc->decoded, NULL);
+    }
+    return LV_RESULT_OK;
+}
+
+/* --------- Fit box --------- */
+static void pt_img_update_fit(lv_display_t *disp)
+{
+#ifdef CONFIG_PT_IMAGE_CACHE_FIT_DISPLAY
+    const uint16_t w = (uint16_t)lv_display_get_horizontal_resolution(disp);
+    const uint16_t h = (uint16_t)lv_display_get_vertical_resolution(disp);
+    PT_IMG_LOCK();
+    const bool changed = pt_img_fit_w && (w != pt_img_fit_w || h != pt_img_fit_h);
+    pt_img_fit_w = w;
+    pt_img_fit_h = h;
+    PT_IMG_UNLOCK();
+    /* Entries were fitted to the old resolution */
+    if (changed)
+        pt_image_cache_clear();
+#else
+    (void)disp;
+#endif
+}
+
+static void pt_img_display_event_cb(lv_event_t *e)
+{
+    pt_img_update_fit((lv_display_t *)lv_event_get_target(e));
+}
+
+/* --------- Public API --------- */
+esp_err_t pt_image_cache_init(size_t budget_bytes)
+{
+    if (pt_img_mutex)
+        return ESP_OK;
+    pt_img_mutex = xSemaphoreCreateMutex();
+    if (!pt_img_mutex)
+        return ESP_ERR_NO_MEM;
+    pt_img_budget = budget_bytes ? budget_bytes : (size_t)CONFIG_PT_IMAGE_CACHE_KB * 1024;
+    pt_img_stats.budget_bytes = (uint32_t)pt_img_budget;
+
+    /* Core 0: decode while LVGL keeps rendering on core 1 */
+    if (xTaskCreatePinnedToCore(pt_img_task, "pt_img", PT_IMG_TASK_STACK, NULL, PT_IMG_TASK_PRIO, &pt_img_task_handle, 0) != pdPASS)
+    {
+        vSemaphoreDelete(pt_img_mutex);
+        pt_img_mutex = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    PT_LVGL_SCOPE_LOCK()
+    {
+        lv_display_t *disp = pt_get_display();
+        if (disp)
+        {
+            pt_img_update_fit(disp);
+            lv_display_add_event_cb(disp, pt_img_display_event_cb, LV_EVENT_RESOLUTION_CHANGED, NULL);
+        }
+        lv_image_decoder_t *dec = lv_image_decoder_create();
+        lv_image_decoder_set_info_cb(dec, pt_img_info_cb);
+        lv_image_decoder_set_open_cb(dec, pt_img_open_cb);
+        /* no close_cb: the pixels belong to the cache */
+        dec->name = "PT_IMAGE_CACHE";
+    }
+    ESP_LOGI(TAG, "Image cache: %u kB budget, fit %ux%u", (unsigned)(pt_img_budget / 1024), pt_img_fit_w, pt_img_fit_h);
+    return ESP_OK;
+}
+
+esp_err_t pt_image_cache_prefetch(const char *const *paths, size_t count)
+{
+    if (!pt_img_mutex)
+        return ESP_ERR_INVALID_STATE;
+    if (!paths && count)
+        return ESP_ERR_INVALID_ARG;
+    if (count > CONFIG_PT_IMAGE_CACHE_PREFETCH_MAX)
+        count = CONFIG_PT_IMAGE_CACHE_PREFETCH_MAX;
+
+    /* Copy outside the lock; the caller's strings may go away once we return */
+    char *dup[CONFIG_PT_IMAGE_CACHE_PREFETCH_MAX];
+    size_t n = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (paths[i] && (dup[n] = strdup(paths[i])) != NULL)
+            n++;
+    }
+    char *stale[CONFIG_PT_IMAGE_CACHE_PREFETCH_MAX];
+    size_t n_stale = 0;
+
+    PT_IMG_LOCK();
+    /* New prefetches go first; earlier ones are dropped, queued conversions follow
+       (those that no longer fit are dropped too) */
+    pt_img_pending_t kept[CONFIG_PT_IMAGE_CACHE_PREFETCH_MAX];
+    size_t n_kept = 0;
+    for (size_t i = 0; i < pt_img_pending_count; i++)
+    {
+        if (pt_img_pending[i].job == PT_IMG_JOB_CONVERT && n + n_kept < CONFIG_PT_IMAGE_CACHE_PREFETCH_MAX)
+            kept[n_kept++] = pt_img_pending[i];
+        else
+        {
+            stale[n_stale++] = pt_img_pending[i].path;
+            pt_img_stats.prefetch_dropped += pt_img_pending[i].job == PT_IMG_JOB_PREFETCH;
+        }
+    }
+    /* Mark cached ones as used in reverse, so the first path ends up most recent;
+       the worker still stats them, so a changed file is decoded again */
+    for (size_t i = n; i-- > 0;)
+    {
+        pt_img_entry_t *e = pt_img_find(dup[i]);
+        if (e)
+            pt_img_touch(e);
+    }
+    pt_img_pending_count = 0;
+    for (size_t i = 0; i < n; i++)
+        pt_img_pending[pt_img_pending_count++] = (pt_img_pending_t){.path = dup[i], .job = PT_IMG_JOB_PREFETCH};
+    for (size_t i = 0; i < n_kept; i++)
+        pt_img_pending[pt_img_pending_count++] = kept[i];
+    PT_IMG_UNLOCK();
+
+    for (size_t i = 0; i < n_stale; i++)
+        free(stale[i]);
+    if (n)
+        xTaskNotifyGive(pt_img_task_handle);
+    return (n == count) ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+esp_err_t pt_image_cache_load(const char *path)
+{
+    if (!pt_img_mutex)
+        return ESP_ERR_INVALID_STATE;
+    if (!path)
+        return ESP_ERR_INVALID_ARG;
+    return pt_img_load(path, PT_IMG_JOB_PREFETCH);
+}
+
+bool pt_image_cache_contains(const char *path)
+{
+    if (!pt_img_mutex || !path)
+        return false;
+    PT_IMG_LOCK();
+    const bool found = pt_img_find(path) != NULL;
+    PT_IMG_UNLOCK();
+    return found;
+}
+
+void pt_image_cache_clear(void)
+{
+    if (!pt_img_mutex)
+        return;
+    PT_IMG_LOCK();
+    const bool any = pt_img_head != NULL;
+    while (pt_img_head)
+        pt_img_retire(pt_img_head);
+    PT_IMG_UNLOCK();
+    if (any)
+        pt_img_schedule_release();
+}
+
+void pt_image_cache_get_stats(pt_image_cache_stats_t *out)
+{
+    if (!out)
+        return;
+    if (!pt_img_mutex)
+    {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    PT_IMG_LOCK();
+    *out = pt_img_stats;
+    out->bytes = (uint32_t)pt_img_bytes;
+    PT_IMG_UNLOCK();
+}
+
+#ifdef CONFIG_PT_ASSET_CACHE
+esp_err_t pt_asset_convert(const char *src)
+{
+    if (!pt_img_mutex)
+        return ESP_ERR_INVALID_STATE;
+    if (!src)
+        return ESP_ERR_INVALID_ARG;
+    char bin[160];
+    struct stat st;
+    if (stat(src, &st) != 0)
+        return ESP_ERR_NOT_FOUND;
+    if (!pt_asset_path(src, &st, bin, sizeof(bin)))
+        return ESP_ERR_NOT_SUPPORTED;
+    return pt_img_load(src, PT_IMG_JOB_CONVERT);
+}
+
+esp_err_t pt_asset_resolve(const char *src, char *out, size_t out_len)
+{
+    if (!src || !out || !out_len)
+        return ESP_ERR_INVALID_ARG;
+    struct stat st;
+    char bin[160];
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+    if (pt_img_mutex && stat(src, &st) == 0 && pt_asset_path(src, &st, bin, sizeof(bin)) && stat(bin, &st) == 0)
+    {
+        src = bin;
+        err = ESP_OK;
+    }
+    if (strlen(src) >= out_len)
+        return ESP_ERR_INVALID_SIZE;
+    strcpy(out, src);
+    return err;
+}
+
+esp_err_t pt_asset_purge(void)
+{
+    const int r = pt_usb_rmdir(PT_ASSET_DIR, true);
+    return (r == 0 || r == -ENOENT) ? ESP_OK : ESP_FAIL;
+}
+#endif /* CONFIG_PT_ASSET_CACHE */
+
+#else /* !CONFIG_PT_IMAGE_CACHE */
+
+esp_err_t pt_image_cache_init(size_t budget_bytes)
+{
+    (void)budget_bytes;
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t pt_image_cache_prefetch(const char *const *paths, size_t count)
+{
+    (void)paths;
+    (void)count;
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t pt_image_cache_load(const char *path)
+{
+    (void)path;
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+bool pt_image_cache_contains(const char *path)
+{
+    (void)path;
+    return false;
+}
+
+void pt_image_cache_clear(void)
+{
+}
+
+void pt_image_cache_get_stats(pt_image_cache_stats_t *out)
+{
+    if (out)
+        memset(out, 0, sizeof(*out));
+}
+
+#endif /* CONFIG_PT_IMAGE_CACHE */
+
+#ifndef CONFIG_PT_ASSET_CACHE
+esp_err_t pt_asset_convert(const char *src)
+{
+    (void)src;
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t pt_asset_resolve(const char *src, char *out, size_t out_len)
+{
+    if (!src || !out || !out_len)
+        return ESP_ERR_INVALID_ARG;
+    if (strlen(src) >= out_len)
+        return ESP_ERR_INVALID_SIZE;
+    strcpy(out, src);
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t pt_asset_purge(void)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+#endif
@@ -0,0 +1,332 @@
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+
+#include "sdkconfig.h"
+#include "lvgl.h"
+#include "pandatouch_lvgl_mem.h"
+
+/* LVGL allocator (lv_mem_init / lv_malloc_core / lv_realloc_core / lv_free_core).
+ *
+ * Two tiers:
+ *  - small: requests up to PT_LVGL_MEM_SMALL_MAX bytes come from a slab arena in internal
+ *    SRAM. The arena is split into 1 kB pages; a page is handed to a power-of-two size
+ *    class the first time that class runs dry and is carved into equal slots kept on a
+ *    per-class free list. A byte per 16-byte granule remembers the requested size so
+ *    realloc and the statistics do not need a header in front of each slot.
+ *  - large: everything else, plus small requests whose class and arena are both full,
+ *    goes to the heap with PSRAM preferred and internal RAM as a fallback.
+ */
+
+#if defined(CONFIG_LV_USE_CUSTOM_MALLOC) && defined(CONFIG_PT_LVGL_USE_PT_INTERNAL_MALLOC)
+
+static const char *TAG = "PandaTouch::LVGLMem";
+
+#define PT_MEM_LARGE_CAPS (MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT)
+#define PT_MEM_LARGE_FALLBACK_CAPS (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)
+
+static portMUX_TYPE pt_mem_mux = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t pt_mem_large_blocks = 0;
+static uint32_t pt_mem_large_bytes = 0;
+static uint32_t pt_mem_large_allocs = 0;
+static uint32_t pt_mem_large_fallbacks = 0;
+
+/* ====================== Small tier (slab arena) ====================== */
+#ifdef CONFIG_PT_LVGL_MEM_TIERED
+#define PT_MEM_PAGE_SIZE 1024
+#define PT_MEM_GRANULE 16
+#define PT_MEM_PAGE_FREE 0xFF
+
+/* Number of classes: 16 .. next power of two >= PT_LVGL_MEM_SMALL_MAX */
+#if CONFIG_PT_LVGL_MEM_SMALL_MAX <= 16
+#define PT_MEM_CLASSES 1
+#elif CONFIG_PT_LVGL_MEM_SMALL_MAX <= 32
+#define PT_MEM_CLASSES 2
+#elif CONFIG_PT_LVGL_MEM_SMALL_MAX <= 64
+#define PT_MEM_CLASSES 3
+#elif CONFIG_PT_LVGL_MEM_SMALL_MAX <= 128
+#define PT_MEM_CLASSES 4
+#else
+#define PT_MEM_CLASSES 5
+#endif
+#define PT_MEM_SMALL_MAX (PT_MEM_GRANULE << (PT_MEM_CLASSES - 1))
+#define PT_MEM_PAGES ((CONFIG_PT_LVGL_MEM_ARENA_KB * 1024) / PT_MEM_PAGE_SIZE)
+
+typedef struct pt_mem_slot
+{
+    struct pt_mem_slot *next;
+} pt_mem_slot_t;
+
+static uint8_t *pt_mem_arena = NULL;
+static uint16_t pt_mem_pages_used = 0;
+static uint8_t pt_mem_page_class[PT_MEM_PAGES];
+static uint8_t *pt_mem_req_size = NULL; /* requested size - 1, per granule (first granule of a slot) */
+static pt_mem_slot_t *pt_mem_free[PT_MEM_CLASSES];
+static pt_lvgl_mem_class_stats_t pt_mem_class[PT_MEM_CLASSES];
+
+static inline bool pt_mem_in_arena(const void *p)
+{
+    return pt_mem_arena && (const uint8_t *)p >= pt_mem_arena &&
+           (const uint8_t *)p < pt_mem_arena + PT_MEM_PAGES * PT_MEM_PAGE_SIZE;
+}
+
+static inline uint32_t pt_mem_class_of(size_t size)
+{
+    uint32_t c = 0;
+    while ((size_t)(PT_MEM_GRANULE << c) < size)
+        c++;
+    return c;
+}
+
+/* Hand a fresh page to class `c` (called inside the critical section) */
+static bool pt_mem_claim_page(uint32_t c)
+{
+    if (pt_mem_pages_used >= PT_MEM_PAGES)
+        return false;
+    const uint16_t page = pt_mem_pages_used++;
+    const uint32_t slot_size = PT_MEM_GRANULE << c;
+    uint8_t *base = pt_mem_arena + (size_t)page * PT_MEM_PAGE_SIZE;
+    pt_mem_page_class[page] = (uint8_t)c;
+    for (uint32_t off = PT_MEM_PAGE_SIZE; off >= slot_size; off -= slot_size)
+    {
+        pt_mem_slot_t *slot = (pt_mem_slot_t *)(base + off - slot_size);
+        slot->next = pt_mem_free[c];
+        pt_mem_free[c] = slot;
+    }
+    pt_mem_class[c].slots_total += PT_MEM_PAGE_SIZE / slot_size;
+    return true;
+}
+
+static void *pt_mem_small_alloc(size_t size)
+{
+    const uint32_t c = pt_mem_class_of(size);
+    void *p = NULL;
+    portENTER_CRITICAL(&pt_mem_mux);
+    if (!pt_mem_free[c])
+        pt_mem_claim_page(c);
+    pt_mem_slot_t *slot = pt_mem_free[c];
+    if (slot)
+    {
+        pt_mem_free[c] = slot->next;
+        pt_mem_req_size[((uint8_t *)slot - pt_mem_arena) / PT_MEM_GRANULE] = (uint8_t)(size - 1);
+        pt_mem_class[c].slots_used++;
+        pt_mem_class[c].bytes_requested += size;
+        pt_mem_class[c].allocs++;
+        p = slot;
+    }
+    else
+    {
+        pt_mem_class[c].spills++;
+    }
+    portEXIT_CRITICAL(&pt_mem_mux);
+    return p;
+}
+
+static size_t pt_mem_small_size(const void *p)
+{
+    return (size_t)pt_mem_req_size[((const uint8_t *)p - pt_mem_arena) / PT_MEM_GRANULE] + 1;
+}
+
+static size_t pt_mem_small_slot_size(const void *p)
+{
+    const uint32_t page = ((const uint8_t *)p - pt_mem_arena) / PT_MEM_PAGE_SIZE;
+    return (size_t)PT_MEM_GRANULE << pt_mem_page_class[page];
+}
+
+static void pt_mem_small_free(void *p)
+{
+    const uint32_t page = ((uint8_t *)p - pt_mem_arena) / PT_MEM_PAGE_SIZE;
+    const uint32_t c = pt_mem_page_class[page];
+    portENTER_CRITICAL(&pt_mem_mux);
+    pt_mem_class[c].slots_used--;
+    pt_mem_class[c].bytes_requested -= pt_mem_small_size(p);
+    pt_mem_slot_t *slot = (pt_mem_slot_t *)p;
+    slot->next = pt_mem_free[c];
+    pt_mem_free[c] = slot;
+    portEXIT_CRITICAL(&pt_mem_mux);
+}
+
+/* Shrink or grow in place within the slot; false if the new size does not fit */
+static bool pt_mem_small_resize(void *p, size_t new_size)
+{
+    if (new_size > pt_mem_small_slot_size(p))
+        return false;
+    const uint32_t c = pt_mem_page_class[((uint8_t *)p - pt_mem_arena) / PT_MEM_PAGE_SIZE];
+    portENTER_CRITICAL(&pt_mem_mux);
+    pt_mem_class[c].bytes_requested = pt_mem_class[c].bytes_requested - pt_mem_small_size(p) + new_size;
+    pt_mem_req_size[((uint8_t *)p - pt_mem_arena) / PT_MEM_GRANULE] = (uint8_t)(new_size - 1);
+    portEXIT_CRITICAL(&pt_mem_mux);
+    return true;
+}
+#endif
+
+/* ====================== Large tier (PSRAM first) ====================== */
+static void pt_mem_large_account(void *p, bool fallback)
+{
+    const size_t sz = heap_caps_get_allocated_size(p);
+    portENTER_CRITICAL(&pt_mem_mux);
+    pt_mem_large_blocks++;
+    pt_mem_large_bytes += sz;
+    pt_mem_large_allocs++;
+    if (fallback)
+        pt_mem_large_fallbacks++;
+    portEXIT_CRITICAL(&pt_mem_mux);
+}
+
+static void pt_mem_large_unaccount(void *p)
+{
+    const size_t sz = heap_caps_get_allocated_size(p);
+    portENTER_CRITICAL(&pt_mem_mux);
+    pt_mem_large_blocks--;
+    pt_mem_large_bytes -= sz;
+    portEXIT_CRITICAL(&pt_mem_mux);
+}
+
+static void *pt_mem_large_alloc(size_t size)
+{
+    bool fallback = false;
+    void *p = heap_caps_malloc(size, PT_MEM_LARGE_CAPS);
+    if (!p)
+    {
+        p = heap_caps_malloc(size, PT_MEM_LARGE_FALLBACK_CAPS);
+        fallback = true;
+    }
+    if (p)
+        pt_mem_large_account(p, fallback);
+    return p;
+}
+
+/* ====================== LVGL hooks ====================== */
+void lv_mem_init(void)
+{
+#ifdef CONFIG_PT_LVGL_MEM_TIERED
+    if (pt_mem_arena)
+        return;
+    const size_t arena_bytes = (size_t)PT_MEM_PAGES * PT_MEM_PAGE_SIZE;
+    pt_mem_arena = heap_caps_aligned_alloc(PT_MEM_GRANULE, arena_bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    pt_mem_req_size = heap_caps_malloc(arena_bytes / PT_MEM_GRANULE, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!pt_mem_arena || !pt_mem_req_size)
+    {
+        ESP_LOGW(TAG, "no internal RAM for a %u kB slab arena, all LVGL allocations go to PSRAM", (unsigned)(arena_bytes / 1024));
+        heap_caps_free(pt_mem_arena);
+        heap_caps_free(pt_mem_req_size);
+        pt_mem_arena = NULL;
+        pt_mem_req_size = NULL;
+        return;
+    }
+    memset(pt_mem_page_class, PT_MEM_PAGE_FREE, sizeof(pt_mem_page_class));
+    for (uint32_t c = 0; c < PT_MEM_CLASSES; ++c)
+        pt_mem_class[c].slot_size = (uint16_t)(PT_MEM_GRANULE << c);
+    ESP_LOGI(TAG, "slab arena: %u kB internal, classes up to %u bytes", (unsigned)(arena_bytes / 1024), (unsigned)PT_MEM_SMALL_MAX);
+#endif
+}
+
+void *lv_malloc_core(size_t size)
+{
+    if (size == 0)
+        return NULL;
+#ifdef CONFIG_PT_LVGL_MEM_TIERED
+    if (pt_mem_arena && size <= PT_MEM_SMALL_MAX)
+    {
+        void *p = pt_mem_small_alloc(size);
+        if (p)
+            return p;
+    }
+#endif
+    return pt_mem_large_alloc(size);
+}
+
+void lv_free_core(void *p)
+{
+    if (!p)
+        return;
+#ifdef CONFIG_PT_LVGL_MEM_TIERED
+    if (pt_mem_in_arena(p))
+    {
+        pt_mem_small_free(p);
+        return;
+    }
+#endif
+    pt_mem_large_unaccount(p);
+    heap_caps_free(p);
+}
+
+void *lv_realloc_core(void *p, size_t new_size)
+{
+    if (!p)
+        return lv_malloc_core(new_size);
+    if (new_size == 0)
+    {
+        lv_free_core(p);
+        return NULL;
+    }
+#ifdef CONFIG_PT_LVGL_MEM_TIERED
+    if (pt_mem_in_arena(p))
+    {
+        if (pt_mem_small_resize(p, new_size))
+            return p;
+        void *np = lv_malloc_core(new_size);
+        if (np)
+        {
+            memcpy(np, p, pt_mem_small_size(p));
+            pt_mem_small_free(p);
+        }
+        return np;
+    }
+#endif
+    /* Large blocks stay in the large tier; heap_caps_realloc keeps the block's caps when it can */
+    pt_mem_large_unaccount(p);
+    void *np = heap_caps_realloc(p, new_size, PT_MEM_LARGE_CAPS);
+    bool fallback = false;
+    if (!np)
+    {
+        np = heap_caps_realloc(p, new_size, PT_MEM_LARGE_FALLBACK_CAPS);
+        fallback = true;
+    }
+    /* On failure `p` is still valid and still ours */
+    pt_mem_large_account(np ? np : p, np && fallback);
+    return np;
+}
+
+bool pt_lvgl_mem_get_stats(pt_lvgl_mem_stats_t *out)
+{
+    if (!out)
+        return false;
+    memset(out, 0, sizeof(*out));
+    portENTER_CRITICAL(&pt_mem_mux);
+#ifdef CONFIG_PT_LVGL_MEM_TIERED
+    if (pt_mem_arena)
+    {
+        out->arena_bytes = PT_MEM_PAGES * PT_MEM_PAGE_SIZE;
+        out->arena_pages_used = pt_mem_pages_used;
+        out->arena_pages_total = PT_MEM_PAGES;
+        out->class_count = PT_MEM_CLASSES;
+        for (uint32_t c = 0; c < PT_MEM_CLASSES; ++c)
+        {
+            const pt_lvgl_mem_class_stats_t *cs = &pt_mem_class[c];
+            out->classes[c] = *cs;
+            out->small_internal_frag_bytes += cs->slots_used * cs->slot_size - cs->bytes_requested;
+            out->small_free_slot_bytes += (cs->slots_total - cs->slots_used) * cs->slot_size;
+        }
+    }
+#endif
+    out->large_blocks = pt_mem_large_blocks;
+    out->large_bytes = pt_mem_large_bytes;
+    out->large_allocs = pt_mem_large_allocs;
+    out->large_internal_fallbacks = pt_mem_large_fallbacks;
+    portEXIT_CRITICAL(&pt_mem_mux);
+    out->psram_free_bytes = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+    out->psram_largest_free_block = heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM);
+    return true;
+}
+
+#else
+
+bool pt_lvgl_mem_get_stats(pt_lvgl_mem_stats_t *out)
+{
+    (void)out;
+    return false;
+}
+
+#endif
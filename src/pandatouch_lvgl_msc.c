@@ -1,7 +1,345 @@
 #include "lvgl.h"
 #include <stdio.h>
 #include <string.h>
+#include <stdatomic.h>
 #include <dirent.h>
+#include <sys/stat.h>
+#include "sdkconfig.h"
+#include "pandatouch_lvgl_msc.h"
+
+#if CONFIG_PT_LVGL_FS_CACHE
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+
+#define TAG "pt_lvgl_fs"
+#endif
+
+// --- File handle ---
+// Every LVGL file is wrapped so read-only files can go through the block cache; other
+// modes (and everything when the cache is off or unavailable) pass straight to stdio.
+typedef struct
+{
+    FILE *fp;
+    bool cached;
+    bool written;      // opened for writing: drop the cache on close
+    uint64_t key;      // path + size + mtime, so rewritten files never hit stale blocks
+    uint32_t size;
+    uint32_t pos;
+    uint32_t next_blk; // block after the last one read, for sequential detection
+} pt_fs_file_t;
+
+#if CONFIG_PT_LVGL_FS_CACHE
+// --- PSRAM block cache ---
+// Fixed-size blocks keyed by (file key, block index) in a chained hash, recency kept in a
+// doubly linked LRU list. pt_lvgl_stdio_fs_cache_invalidate() only bumps the atomic
+// s_cache_gen and s_cache_invalidations and never takes the lock (a reader holds it across
+// USB transfers that need the USB task), so it is safe from the USB task; the next read
+// notices and resets the tables.
+#define PT_FS_BLOCK ((uint32_t)(CONFIG_PT_LVGL_FS_CACHE_BLOCK / 512) * 512)
+#define PT_FS_NONE (-1)
+
+typedef struct
+{
+    uint64_t key;
+    uint32_t blk;
+    uint32_t len;       // valid bytes; short for the last block of a file
+    uint32_t gen;       // 0: free
+    int32_t prev, next; // LRU list, head = most recently used
+    int32_t hnext;      // hash chain
+} pt_fs_slot_t;
+
+static struct
+{
+    pt_fs_slot_t *slots;
+    uint8_t *data;    // nblocks * PT_FS_BLOCK
+    uint8_t *staging; // one readahead run
+    uint32_t staging_bytes;
+    int32_t *buckets;
+    uint32_t mask;
+    int32_t nblocks;
+    int32_t head, tail;
+    uint32_t seen_gen;
+    SemaphoreHandle_t lock;
+    pt_lvgl_fs_cache_stats_t stats;
+} s_cache;
+
+static _Atomic uint32_t s_cache_gen = 1;
+static _Atomic uint32_t s_cache_invalidations = 0;
+
+static uint64_t pt_fs_key(const char *path, const struct stat *st)
+{
+    // FNV-1a over the path, then the size and mtime
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (const unsigned char *c = (const unsigned char *)path; *c; c++)
+        h = (h ^ *c) * 0x100000001b3ULL;
+    h = (h ^ (uint64_t)st->st_size) * 0x100000001b3ULL;
+    h = (h ^ (uint64_t)st->st_mtime) * 0x100000001b3ULL;
+    return h;
+}
+
+static inline uint32_t pt_fs_bucket(uint64_t key, uint32_t blk)
+{
+    return (uint32_t)((key ^ (key >> 32)) ^ (blk * 0x9E3779B1u)) & s_cache.mask;
+}
+
+static void pt_fs_cache_reset(void)
+{
+    for (uint32_t i = 0; i <= s_cache.mask; i++)
+        s_cache.buckets[i] = PT_FS_NONE;
+    for (int32_t i = 0; i < s_cache.nblocks; i++)
+    {
+        s_cache.slots[i].gen = 0;
+        s_cache.slots[i].hnext = PT_FS_NONE;
+        s_cache.slots[i].prev = i - 1;
+        s_cache.slots[i].next = (i + 1 < s_cache.nblocks) ? i + 1 : PT_FS_NONE;
+    }
+    s_cache.head = 0;
+    s_cache.tail = s_cache.nblocks - 1;
+}
+
+static void pt_fs_lru_touch(int32_t i)
+{
+    pt_fs_slot_t *s = &s_cache.slots[i];
+    if (s_cache.head == i)
+        return;
+    // unlink
+    s_cache.slots[s->prev].next = s->next;
+    if (s->next != PT_FS_NONE)
+        s_cache.slots[s->next].prev = s->prev;
+    else
+        s_cache.tail = s->prev;
+    // push front
+    s->prev = PT_FS_NONE;
+    s->next = s_cache.head;
+    s_cache.slots[s_cache.head].prev = i;
+    s_cache.head = i;
+}
+
+static int32_t pt_fs_lookup(uint64_t key, uint32_t blk)
+{
+    for (int32_t i = s_cache.buckets[pt_fs_bucket(key, blk)]; i != PT_FS_NONE; i = s_cache.slots[i].hnext)
+    {
+        const pt_fs_slot_t *s = &s_cache.slots[i];
+        if (s->key == key && s->blk == blk)
+            return i;
+    }
+    return PT_FS_NONE;
+}
+
+// Least recently used slot, unlinked from its hash chain
+static int32_t pt_fs_take_slot(void)
+{
+    const int32_t i = s_cache.tail;
+    pt_fs_slot_t *s = &s_cache.slots[i];
+    if (s->gen != 0)
+    {
+        int32_t *link = &s_cache.buckets[pt_fs_bucket(s->key, s->blk)];
+        while (*link != i)
+            link = &s_cache.slots[*link].hnext;
+        *link = s->hnext;
+        s->gen = 0;
+        s_cache.stats.evictions++;
+    }
+    return i;
+}
+
+static void pt_fs_insert(int32_t i, uint64_t key, uint32_t blk, uint32_t len)
+{
+    pt_fs_slot_t *s = &s_cache.slots[i];
+    s->key = key;
+    s->blk = blk;
+    s->len = len;
+    s->gen = s_cache.seen_gen;
+    const uint32_t b = pt_fs_bucket(key, blk);
+    s->hnext = s_cache.buckets[b];
+    s_cache.buckets[b] = i;
+    pt_fs_lru_touch(i);
+}
+
+// Miss on `blk`: read it, plus the following blocks when the access is sequential,
+// in one transfer. Returns the slot holding `blk`.
+static int32_t pt_fs_fill(pt_fs_file_t *f, uint32_t blk)
+{
+    const uint32_t file_blocks = (f->size + PT_FS_BLOCK - 1) / PT_FS_BLOCK;
+    uint32_t run = 1;
+    if (blk == f->next_blk)
+    {
+        run = s_cache.staging_bytes / PT_FS_BLOCK;
+        if (run > file_blocks - blk)
+            run = file_blocks - blk;
+        for (uint32_t j = 1; j < run; j++)
+        {
+            if (pt_fs_lookup(f->key, blk + j) != PT_FS_NONE)
+            {
+                run = j;
+                break;
+            }
+        }
+    }
+
+    int32_t first = pt_fs_take_slot();
+    uint8_t *dst = (run == 1) ? &s_cache.data[(size_t)first * PT_FS_BLOCK] : s_cache.staging;
+    if (fseek(f->fp, (long)blk * PT_FS_BLOCK, SEEK_SET) != 0)
+        return PT_FS_NONE;
+    const size_t got = fread(dst, 1, (size_t)run * PT_FS_BLOCK, f->fp);
+    if (got == 0)
+        return PT_FS_NONE;
+    s_cache.stats.misses++;
+    s_cache.stats.disk_bytes += got;
+
+    for (uint32_t j = 0; j < run && j * PT_FS_BLOCK < got; j++)
+    {
+        const uint32_t len = (got - j * PT_FS_BLOCK < PT_FS_BLOCK) ? (uint32_t)(got - j * PT_FS_BLOCK) : PT_FS_BLOCK;
+        int32_t i = first;
+        if (j > 0)
+        {
+            i = pt_fs_take_slot();
+            memcpy(&s_cache.data[(size_t)i * PT_FS_BLOCK], dst + j * PT_FS_BLOCK, len);
+            s_cache.stats.readahead_blocks++;
+        }
+        else if (run > 1)
+        {
+            memcpy(&s_cache.data[(size_t)i * PT_FS_BLOCK], dst, len);
+        }
+        pt_fs_insert(i, f->key, blk + j, len);
+    }
+    // the requested block is about to be used; keep it ahead of its readahead
+    pt_fs_lru_touch(first);
+    return first;
+}
+
+static lv_fs_res_t pt_fs_cached_read(pt_fs_file_t *f, uint8_t *buf, uint32_t btr, uint32_t *br)
+{
+    uint32_t done = 0;
+    lv_fs_res_t res = LV_FS_RES_OK;
+    if (f->pos < f->size && btr > f->size - f->pos)
+        btr = f->size - f->pos;
+    if (f->pos >= f->size)
+        btr = 0;
+
+    if (btr > s_cache.staging_bytes)
+    {
+        // Bigger than a readahead run (e.g. a whole PNG): one direct transfer beats
+        // copying it through the cache and flushing everything else out
+        if (fseek(f->fp, (long)f->pos, SEEK_SET) != 0)
+            return LV_FS_RES_FS_ERR;
+        done = (uint32_t)fread(buf, 1, btr, f->fp);
+        f->pos += done;
+        f->next_blk = (f->pos + PT_FS_BLOCK - 1) / PT_FS_BLOCK;
+        xSemaphoreTake(s_cache.lock, portMAX_DELAY);
+        s_cache.stats.bypass_reads++;
+        s_cache.stats.disk_bytes += done;
+        xSemaphoreGive(s_cache.lock);
+        if (br)
+            *br = done;
+        return (done == btr) ? LV_FS_RES_OK : LV_FS_RES_FS_ERR;
+    }
+
+    xSemaphoreTake(s_cache.lock, portMAX_DELAY);
+    const uint32_t gen = atomic_load(&s_cache_gen);
+    if (s_cache.seen_gen != gen)
+    {
+        s_cache.seen_gen = gen;
+        pt_fs_cache_reset();
+    }
+    while (done < btr)
+    {
+        const uint32_t blk = f->pos / PT_FS_BLOCK;
+        const uint32_t off = f->pos % PT_FS_BLOCK;
+        int32_t i = pt_fs_lookup(f->key, blk);
+        if (i != PT_FS_NONE)
+        {
+            s_cache.stats.hits++;
+            pt_fs_lru_touch(i);
+        }
+        else if ((i = pt_fs_fill(f, blk)) == PT_FS_NONE)
+        {
+            res = LV_FS_RES_FS_ERR;
+            break;
+        }
+        f->next_blk = blk + 1;
+        const pt_fs_slot_t *s = &s_cache.slots[i];
+        if (s->len <= off)
+            break; // file shrank underneath us
+        uint32_t n = s->len - off;
+        if (n > btr - done)
+            n = btr - done;
+        memcpy(buf + done, &s_cache.data[(size_t)i * PT_FS_BLOCK + off], n);
+        done += n;
+        f->pos += n;
+    }
+    xSemaphoreGive(s_cache.lock);
+    if (br)
+        *br = done;
+    return res;
+}
+
+static void pt_fs_cache_init(void)
+{
+    const size_t budget = (size_t)CONFIG_PT_LVGL_FS_CACHE_KB * 1024;
+    int32_t n = (int32_t)(budget / PT_FS_BLOCK);
+    uint32_t run = 1 + CONFIG_PT_LVGL_FS_CACHE_READAHEAD;
+    if (n < 2)
+        n = 2;
+    if (run > (uint32_t)n / 2)
+        run = (uint32_t)n / 2; // a run must never evict its own first block
+    uint32_t buckets = 1;
+    while (buckets < (uint32_t)n)
+        buckets <<= 1;
+
+    s_cache.lock = xSemaphoreCreateMutex();
+    s_cache.data = heap_caps_aligned_alloc(64, (size_t)n * PT_FS_BLOCK, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    s_cache.staging = (run > 1) ? heap_caps_aligned_alloc(64, (size_t)run * PT_FS_BLOCK, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT) : NULL;
+    s_cache.slots = heap_caps_calloc(n, sizeof(pt_fs_slot_t), MALLOC_CAP_8BIT);
+    s_cache.buckets = heap_caps_malloc(buckets * sizeof(int32_t), MALLOC_CAP_8BIT);
+    if (!s_cache.lock || !s_cache.data || (run > 1 && !s_cache.staging) || !s_cache.slots || !s_cache.buckets)
+    {
+        ESP_LOGW(TAG, "No memory for a %u kB block cache; LVGL file reads go straight to USB",
+                 (unsigned)CONFIG_PT_LVGL_FS_CACHE_KB);
+        if (s_cache.lock)
+            vSemaphoreDelete(s_cache.lock);
+        heap_caps_free(s_cache.data);
+        heap_caps_free(s_cache.staging);
+        heap_caps_free(s_cache.slots);
+        heap_caps_free(s_cache.buckets);
+        memset(&s_cache, 0, sizeof(s_cache));
+        return;
+    }
+    s_cache.nblocks = n;
+    s_cache.mask = buckets - 1;
+    s_cache.staging_bytes = run * PT_FS_BLOCK;
+    s_cache.seen_gen = atomic_load(&s_cache_gen);
+    s_cache.stats.blocks = (uint32_t)n;
+    s_cache.stats.block_size = PT_FS_BLOCK;
+    pt_fs_cache_reset();
+}
+#endif // CONFIG_PT_LVGL_FS_CACHE
+
+void pt_lvgl_stdio_fs_cache_invalidate(void)
+{
+#if CONFIG_PT_LVGL_FS_CACHE
+    atomic_fetch_add(&s_cache_gen, 1);
+    atomic_fetch_add(&s_cache_invalidations, 1);
+#endif
+}
+
+void pt_lvgl_stdio_fs_cache_get_stats(pt_lvgl_fs_cache_stats_t *out)
+{
+    if (!out)
+        return;
+    memset(out, 0, sizeof(*out));
+#if CONFIG_PT_LVGL_FS_CACHE
+    if (s_cache.lock)
+    {
+        xSemaphoreTake(s_cache.lock, portMAX_DELAY);
+        *out = s_cache.stats;
+        xSemaphoreGive(s_cache.lock);
+    }
+    out->invalidations = atomic_load(&s_cache_invalidations);
+#endif
+}
 
 // --- LVGL v9 stdio FS driver implementation ---
 // LVGL v9 API: open returns a handle (void*), seek has whence, directory ops use handles
@@ -19,23 +357,53 @@ static void *lvgl_stdio_open(lv_fs_drv_t *drv, const char *path, lv_fs_mode_t mo
         use_path = tmp;
     }
     FILE *fp = fopen(use_path, m);
-    return fp; /* returned as the file handle */
+    if (!fp)
+        return NULL;
+    pt_fs_file_t *f = lv_malloc_zeroed(sizeof(*f));
+    if (!f)
+    {
+        fclose(fp);
+        return NULL;
+    }
+    f->fp = fp;
+    f->written = (mode != LV_FS_MODE_RD);
+#if CONFIG_PT_LVGL_FS_CACHE
+    struct stat st;
+    if (mode == LV_FS_MODE_RD && s_cache.nblocks && fstat(fileno(fp), &st) == 0 && st.st_size <= (off_t)INT32_MAX)
+    {
+        f->cached = true;
+        f->key = pt_fs_key(use_path, &st);
+        f->size = (uint32_t)st.st_size;
+        f->next_blk = 0; // the first read from offset 0 reads ahead: small files arrive in one transfer
+        // Every transfer is a whole cache block or run; stdio's own buffer would only add a copy
+        setvbuf(fp, NULL, _IONBF, 0);
+    }
+#endif
+    return f; /* returned as the file handle */
 }
 
 static lv_fs_res_t lvgl_stdio_close(lv_fs_drv_t *drv, void *file_p)
 {
     (void)drv;
-    FILE *fp = (FILE *)file_p;
-    if (fp)
-        fclose(fp);
+    pt_fs_file_t *f = (pt_fs_file_t *)file_p;
+    if (!f)
+        return LV_FS_RES_OK;
+    fclose(f->fp);
+    if (f->written)
+        pt_lvgl_stdio_fs_cache_invalidate();
+    lv_free(f);
     return LV_FS_RES_OK;
 }
 
 static lv_fs_res_t lvgl_stdio_read(lv_fs_drv_t *drv, void *file_p, void *buf, uint32_t btr, uint32_t *br)
 {
     (void)drv;
-    FILE *fp = (FILE *)file_p;
-    size_t r = fread(buf, 1, btr, fp);
+    pt_fs_file_t *f = (pt_fs_file_t *)file_p;
+#if CONFIG_PT_LVGL_FS_CACHE
+    if (f->cached)
+        return pt_fs_cached_read(f, (uint8_t *)buf, btr, br);
+#endif
+    size_t r = fread(buf, 1, btr, f->fp);
     if (br)
         *br = (uint32_t)r;
     return LV_FS_RES_OK;
@@ -44,8 +412,8 @@ static lv_fs_res_t lvgl_stdio_read(lv_fs_drv_t *drv, void *file_p, void *buf, ui
 static lv_fs_res_t lvgl_stdio_write(lv_fs_drv_t *drv, void *file_p, const void *buf, uint32_t btw, uint32_t *bw)
 {
     (void)drv;
-    FILE *fp = (FILE *)file_p;
-    size_t w = fwrite(buf, 1, btw, fp);
+    pt_fs_file_t *f = (pt_fs_file_t *)file_p;
+    size_t w = fwrite(buf, 1, btw, f->fp);
     if (bw)
         *bw = (uint32_t)w;
     return (w == btw) ? LV_FS_RES_OK : LV_FS_RES_FS_ERR;
@@ -54,7 +422,22 @@ static lv_fs_res_t lvgl_stdio_write(lv_fs_drv_t *drv, void *file_p, const void *
 static lv_fs_res_t lvgl_stdio_seek(lv_fs_drv_t *drv, void *file_p, uint32_t pos, lv_fs_whence_t whence)
 {
     (void)drv;
-    FILE *fp = (FILE *)file_p;
+    pt_fs_file_t *f = (pt_fs_file_t *)file_p;
+    if (f->cached)
+    {
+        // Only the logical position moves; the next miss seeks the FILE itself
+        int64_t p = (int32_t)pos;
+        if (whence == LV_FS_SEEK_SET)
+            p = pos;
+        else if (whence == LV_FS_SEEK_CUR)
+            p += f->pos;
+        else if (whence == LV_FS_SEEK_END)
+            p += f->size;
+        if (p < 0 || p > (int64_t)UINT32_MAX)
+            return LV_FS_RES_FS_ERR;
+        f->pos = (uint32_t)p;
+        return LV_FS_RES_OK;
+    }
     int w = SEEK_SET;
     if (whence == LV_FS_SEEK_SET)
         w = SEEK_SET;
@@ -62,14 +445,20 @@ static lv_fs_res_t lvgl_stdio_seek(lv_fs_drv_t *drv, void *file_p, uint32_t pos,
         w = SEEK_CUR;
     else if (whence == LV_FS_SEEK_END)
         w = SEEK_END;
-    return (fseek(fp, (long)pos, w) == 0) ? LV_FS_RES_OK : LV_FS_RES_FS_ERR;
+    return (fseek(f->fp, (long)pos, w) == 0) ? LV_FS_RES_OK : LV_FS_RES_FS_ERR;
 }
 
 static lv_fs_res_t lvgl_stdio_tell(lv_fs_drv_t *drv, void *file_p, uint32_t *pos_p)
 {
     (void)drv;
-    FILE *fp = (FILE *)file_p;
-    long off = ftell(fp);
+    pt_fs_file_t *f = (pt_fs_file_t *)file_p;
+    if (f->cached)
+    {
+        if (pos_p)
+            *pos_p = f->pos;
+        return LV_FS_RES_OK;
+    }
+    long off = ftell(f->fp);
     if (off < 0)
         return LV_FS_RES_FS_ERR;
     if (pos_p)
@@ -119,6 +508,10 @@ void pt_lvgl_stdio_fs_init(void)
         return;
     inited = true;
 
+#if CONFIG_PT_LVGL_FS_CACHE
+    pt_fs_cache_init();
+#endif
+
     static lv_fs_drv_t drv;
     lv_fs_drv_init(&drv);
     drv.letter = '/'; /* use '/' to support POSIX absolute paths like "/usb/..." */
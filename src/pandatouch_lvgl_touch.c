@@ -1,36 +1,474 @@
 #include "pandatouch_lvgl_touch.h"
+#include "sdkconfig.h"
 #include "pandatouch_touch.h"
+#include "pandatouch_display.h"
+#ifdef CONFIG_PT_TOUCH_REPLAY
+#include "pandatouch_touch_replay.h"
+#endif
 #include "esp_log.h"
+#include "esp_check.h"
+#include "esp_attr.h"
 #include <string.h>
+#include <stdlib.h>
 #include "esp_heap_caps.h"
+#if defined(CONFIG_PT_LVGL_TOUCH_FILTER) || defined(CONFIG_PT_LVGL_TOUCH_PREDICT)
+#include "esp_timer.h"
+#endif
+#include <math.h>
+#ifdef CONFIG_PT_LVGL_TOUCH_CAL_NVS
+#include "nvs.h"
+#endif
 
 static const char *TAG = "PandaTouch::LVGL_Touch";
 
 typedef struct
 {
-    int tp_w, tp_h;   // raw touch space (from controller)
-    int scr_w, scr_h; // LVGL display resolution
+    int tp_w, tp_h;             // raw touch space (from controller)
+    int scr_w, scr_h;           // display resolution in the panel's native orientation
+    pt_lvgl_touch_matrix_t m;   // raw -> native display, Q16
+    bool identity;              // m is the identity: skip the multiplies
+    bool calibrated;            // m came from pt_lvgl_touch_set_matrix(), not scale + orientation
+    uint8_t orient;             // PT_LVGL_TOUCH_ORIENT_* flags
+    int raw_x, raw_y;           // last raw point of the pointer (calibration UIs)
+    lv_indev_state_t last_state;
+    int last_x, last_y;
+    uint32_t last_fresh_ms; // lv_tick of the last frame the controller reported
 } pt_lvgl_touch_ctx_t;
 
+/* GT911 reports every ~10 ms while touched; a longer silence means the lift frame was lost */
+#define PT_LVGL_TOUCH_STALE_MS 100
+
 static pt_lvgl_touch_ctx_t s_ctx = {0};
+static lv_indev_t *s_indev = NULL;
+static volatile bool s_int_pending = false;
+static bool s_use_task = false;   /* frames come from the touch sampling task's queue */
+static bool s_event_mode = false; /* read on INT/requests only, not by LVGL's indev timer */
+
+/* Read the device on the next LVGL task pass. Runs in the touch sampling task after each queued
+   frame, and from timers when a debounced release or a replayed frame becomes due. */
+static void pt_lvgl_touch_request_read(void *arg)
+{
+    (void)arg;
+    s_int_pending = true;
+    pt_display_wake();
+}
 
-/* Simple mapper from raw controller space -> LVGL display space */
+/* Raw controller space -> native display space through the Q16 affine transform.
+   LVGL rotates pointer input itself, so the result is in the unrotated panel orientation. */
 static inline void pt_lvgl_touch_map_point(int rx, int ry, int *ox, int *oy)
 {
-    int x = rx;
-    int y = ry;
+    int32_t x = rx;
+    int32_t y = ry;
+
+    // Identity (PT_TOUCH_GT911_MATCH_RESOLUTION, no orientation flags): only clamp
+    if (!s_ctx.identity)
+    {
+        const pt_lvgl_touch_matrix_t *m = &s_ctx.m;
+        x = (int32_t)(((int64_t)m->a * rx + (int64_t)m->b * ry + m->c + 0x8000) >> 16);
+        y = (int32_t)(((int64_t)m->d * rx + (int64_t)m->e * ry + m->f + 0x8000) >> 16);
+    }
 
-    /* No swap/invert for this screen: coordinates map directly */
+    *ox = x < 0 ? 0 : (x >= s_ctx.scr_w ? s_ctx.scr_w - 1 : x);
+    *oy = y < 0 ? 0 : (y >= s_ctx.scr_h ? s_ctx.scr_h - 1 : y);
+}
+
+/* Scale the controller range onto the panel, then apply the sensor mounting flags */
+static void pt_lvgl_touch_default_matrix(pt_lvgl_touch_matrix_t *m)
+{
+    const bool swap = s_ctx.orient & PT_LVGL_TOUCH_ORIENT_SWAP_XY;
+    const int src_w = swap ? s_ctx.tp_h : s_ctx.tp_w; // raw axis that drives display x
+    const int src_h = swap ? s_ctx.tp_w : s_ctx.tp_h;
+    const int32_t sx = (int32_t)(((int64_t)(s_ctx.scr_w - 1) << 16) / (src_w > 1 ? src_w - 1 : 1));
+    const int32_t sy = (int32_t)(((int64_t)(s_ctx.scr_h - 1) << 16) / (src_h > 1 ? src_h - 1 : 1));
+
+    memset(m, 0, sizeof(*m));
+    if (swap)
+    {
+        m->b = sx;
+        m->d = sy;
+    }
+    else
+    {
+        m->a = sx;
+        m->e = sy;
+    }
+    if (s_ctx.orient & PT_LVGL_TOUCH_ORIENT_INVERT_X)
+    {
+        m->a = -m->a;
+        m->b = -m->b;
+        m->c = (s_ctx.scr_w - 1) << 16;
+    }
+    if (s_ctx.orient & PT_LVGL_TOUCH_ORIENT_INVERT_Y)
+    {
+        m->d = -m->d;
+        m->e = -m->e;
+        m->f = (s_ctx.scr_h - 1) << 16;
+    }
+}
 
-    // Scale to display
-    // (int64 to avoid overflow if someone uses large coords)
-    int32_t dx = (int32_t)x * (s_ctx.scr_w - 1) / (s_ctx.tp_w - 1 ? s_ctx.tp_w - 1 : 1);
-    int32_t dy = (int32_t)y * (s_ctx.scr_h - 1) / (s_ctx.tp_h - 1 ? s_ctx.tp_h - 1 : 1);
+/* Recompute the native resolution and, unless calibrated, the default transform.
+   Runs at init, on LV_EVENT_RESOLUTION_CHANGED (rotation) and when the settings change. */
+static void pt_lvgl_touch_update_transform(void)
+{
+    lv_display_t *disp = s_indev ? lv_indev_get_display(s_indev) : NULL;
+    if (disp)
+    {
+        const lv_display_rotation_t rot = lv_display_get_rotation(disp);
+        const bool rotated = rot == LV_DISPLAY_ROTATION_90 || rot == LV_DISPLAY_ROTATION_270;
+        const int hor = lv_display_get_horizontal_resolution(disp);
+        const int ver = lv_display_get_vertical_resolution(disp);
+        s_ctx.scr_w = rotated ? ver : hor;
+        s_ctx.scr_h = rotated ? hor : ver;
+    }
+    if (!s_ctx.calibrated)
+        pt_lvgl_touch_default_matrix(&s_ctx.m);
+    const pt_lvgl_touch_matrix_t *m = &s_ctx.m;
+    s_ctx.identity = m->a == 65536 && m->b == 0 && m->c == 0 && m->d == 0 && m->e == 65536 && m->f == 0;
+}
 
-    *ox = dx < 0 ? 0 : (dx >= s_ctx.scr_w ? s_ctx.scr_w - 1 : dx);
-    *oy = dy < 0 ? 0 : (dy >= s_ctx.scr_h ? s_ctx.scr_h - 1 : dy);
+static void pt_lvgl_touch_disp_event_cb(lv_event_t *e)
+{
+    (void)e;
+    pt_lvgl_touch_update_transform();
 }
 
+/* Screen point as LVGL objects see it (current rotation) -> native panel orientation */
+static void pt_lvgl_touch_to_native(int lx, int ly, double *nx, double *ny)
+{
+    lv_display_t *disp = s_indev ? lv_indev_get_display(s_indev) : NULL;
+    const int w = s_ctx.scr_w, h = s_ctx.scr_h;
+    switch (disp ? lv_display_get_rotation(disp) : LV_DISPLAY_ROTATION_0)
+    {
+    case LV_DISPLAY_ROTATION_90:
+        *nx = ly;
+        *ny = h - 1 - lx;
+        break;
+    case LV_DISPLAY_ROTATION_180:
+        *nx = w - 1 - lx;
+        *ny = h - 1 - ly;
+        break;
+    case LV_DISPLAY_ROTATION_270:
+        *nx = w - 1 - ly;
+        *ny = lx;
+        break;
+    default:
+        *nx = lx;
+        *ny = ly;
+        break;
+    }
+}
+
+#ifdef CONFIG_PT_LVGL_TOUCH_CAL_NVS
+#define PT_LVGL_TOUCH_NVS_NS "pt_touch"
+#define PT_LVGL_TOUCH_NVS_KEY "cal"
+#define PT_LVGL_TOUCH_CAL_MAGIC 0x31435450u /* "PTC1" */
+
+typedef struct
+{
+    uint32_t magic;
+    uint16_t scr_w, scr_h; // native resolution the matrix was computed for
+    pt_lvgl_touch_matrix_t m;
+} pt_lvgl_touch_cal_blob_t;
+
+static void pt_lvgl_touch_load_calibration(void)
+{
+    nvs_handle_t h;
+    if (nvs_open(PT_LVGL_TOUCH_NVS_NS, NVS_READONLY, &h) != ESP_OK)
+        return; // nothing saved yet, or NVS not initialized by the application
+    pt_lvgl_touch_cal_blob_t blob;
+    size_t len = sizeof(blob);
+    const esp_err_t err = nvs_get_blob(h, PT_LVGL_TOUCH_NVS_KEY, &blob, &len);
+    nvs_close(h);
+    if (err != ESP_OK || len != sizeof(blob) || blob.magic != PT_LVGL_TOUCH_CAL_MAGIC)
+        return;
+    if (blob.scr_w != s_ctx.scr_w || blob.scr_h != s_ctx.scr_h)
+    {
+        ESP_LOGW(TAG, "stored calibration is for %ux%u, ignoring", blob.scr_w, blob.scr_h);
+        return;
+    }
+    s_ctx.m = blob.m;
+    s_ctx.calibrated = true;
+    ESP_LOGI(TAG, "touch calibration loaded from NVS");
+}
+#endif
+
+#ifdef CONFIG_PT_LVGL_TOUCH_FILTER
+/* Jitter filter: press debounce -> EMA (Q8) -> deadband -> release debounce, in display pixels */
+typedef struct
+{
+    bool down;              // press currently reported to LVGL
+    uint8_t press_count;    // touched frames seen while not yet down
+    int32_t ema_x, ema_y;   // smoothed point, Q8
+    int out_x, out_y;       // last point reported to LVGL
+    int64_t release_at_us;  // pending debounced release (0 = none)
+} pt_lvgl_touch_filter_state_t;
+
+static pt_lvgl_touch_filter_t s_filt = {
+    .debounce_en = CONFIG_PT_LVGL_TOUCH_FILTER_PRESS_FRAMES > 1 || CONFIG_PT_LVGL_TOUCH_FILTER_RELEASE_MS > 0,
+    .press_frames = CONFIG_PT_LVGL_TOUCH_FILTER_PRESS_FRAMES,
+    .release_ms = CONFIG_PT_LVGL_TOUCH_FILTER_RELEASE_MS,
+    .ema_en = CONFIG_PT_LVGL_TOUCH_FILTER_EMA_ALPHA < 256,
+    .ema_alpha_q8 = CONFIG_PT_LVGL_TOUCH_FILTER_EMA_ALPHA,
+    .deadband_en = CONFIG_PT_LVGL_TOUCH_FILTER_DEADBAND_PX > 0,
+    .deadband_px = CONFIG_PT_LVGL_TOUCH_FILTER_DEADBAND_PX,
+};
+static pt_lvgl_touch_filter_state_t s_fs = {0};
+static esp_timer_handle_t s_release_timer = NULL;
+
+static void pt_lvgl_touch_filter_reset(void)
+{
+    if (s_fs.release_at_us && s_release_timer)
+        esp_timer_stop(s_release_timer);
+    memset(&s_fs, 0, sizeof(s_fs));
+    s_fs.down = (s_ctx.last_state == LV_INDEV_STATE_PRESSED);
+    s_fs.out_x = s_ctx.last_x;
+    s_fs.out_y = s_ctx.last_y;
+    s_fs.ema_x = s_fs.out_x << 8;
+    s_fs.ema_y = s_fs.out_y << 8;
+}
+
+/* One controller frame in, filtered state out. `x`/`y` hold the mapped point and receive the
+   point to report (the last reported one when nothing should move). */
+static bool pt_lvgl_touch_filter_frame(bool touched, int *x, int *y)
+{
+    const bool release_db = s_filt.debounce_en && s_filt.release_ms > 0 && s_release_timer;
+
+    if (!touched)
+    {
+        s_fs.press_count = 0;
+        *x = s_fs.out_x;
+        *y = s_fs.out_y;
+        if (!s_fs.down)
+            return false;
+        if (release_db)
+        {
+            const int64_t now = esp_timer_get_time();
+            if (!s_fs.release_at_us)
+            {
+                s_fs.release_at_us = now + (int64_t)s_filt.release_ms * 1000;
+                esp_timer_start_once(s_release_timer, (uint64_t)s_filt.release_ms * 1000);
+            }
+            if (now < s_fs.release_at_us)
+                return true;
+        }
+        s_fs.down = false;
+        s_fs.release_at_us = 0;
+        return false;
+    }
+
+    if (s_fs.release_at_us)
+    {
+        // Finger came back before the release was reported: it was a dropped frame
+        esp_timer_stop(s_release_timer);
+        s_fs.release_at_us = 0;
+    }
+
+    if (!s_fs.down)
+    {
+        if (s_filt.debounce_en && ++s_fs.press_count < s_filt.press_frames)
+        {
+            *x = s_fs.out_x;
+            *y = s_fs.out_y;
+            return false;
+        }
+        // New press: start the smoothers at the raw point so it does not glide in from the last one
+        s_fs.press_count = 0;
+        s_fs.down = true;
+        s_fs.ema_x = *x << 8;
+        s_fs.ema_y = *y << 8;
+        s_fs.out_x = *x;
+        s_fs.out_y = *y;
+        return true;
+    }
+
+    int fx = *x, fy = *y;
+    if (s_filt.ema_en)
+    {
+        s_fs.ema_x += (((int32_t)fx << 8) - s_fs.ema_x) * s_filt.ema_alpha_q8 >> 8;
+        s_fs.ema_y += (((int32_t)fy << 8) - s_fs.ema_y) * s_filt.ema_alpha_q8 >> 8;
+        fx = (s_fs.ema_x + 128) >> 8;
+        fy = (s_fs.ema_y + 128) >> 8;
+    }
+    if (s_filt.deadband_en && abs(fx - s_fs.out_x) <= s_filt.deadband_px && abs(fy - s_fs.out_y) <= s_filt.deadband_px)
+    {
+        fx = s_fs.out_x;
+        fy = s_fs.out_y;
+    }
+    *x = s_fs.out_x = fx;
+    *y = s_fs.out_y = fy;
+    return true;
+}
+
+/* No new frame: report a debounced release once its deadline passed */
+static bool pt_lvgl_touch_filter_release_due(void)
+{
+    if (!s_fs.release_at_us || esp_timer_get_time() < s_fs.release_at_us)
+        return false;
+    s_fs.down = false;
+    s_fs.release_at_us = 0;
+    return true;
+}
+#endif
+
+#ifdef CONFIG_PT_LVGL_TOUCH_PREDICT
+/* Drag predictor: constant-acceleration extrapolation over the last three frames */
+#define PT_LVGL_TOUCH_PREDICT_GAP_US 50000 // no frame for this long = finger paused, start over
+
+typedef struct
+{
+    int x, y;
+    int64_t t_us;
+} pt_lvgl_touch_sample_t;
+
+static pt_lvgl_touch_sample_t s_hist[3]; // oldest first, measured (unpredicted) points
+static uint8_t s_hist_n = 0;
+static int s_pred_x, s_pred_y; // last predicted point reported while pressed
+static volatile uint16_t s_predict_ms = CONFIG_PT_LVGL_TOUCH_PREDICT_MS;
+
+static int pt_lvgl_touch_predict_axis(int p, float v, float a, float h, int size)
+{
+    float d = v * h + 0.5f * a * h * h;
+    // Decelerating to a stop inside the horizon: don't let the parabola swing back
+    if (d * v <= 0.0f)
+        return p;
+    const float lim = (float)CONFIG_PT_LVGL_TOUCH_PREDICT_MAX_PX;
+    d = d > lim ? lim : (d < -lim ? -lim : d);
+    const int out = p + (int)lroundf(d);
+    return out < 0 ? 0 : (out >= size ? size - 1 : out);
+}
+
+/* Record a pressed sample taken at `t_us` and replace `x`/`y` with the point expected on screen */
+static void pt_lvgl_touch_predict(int64_t t_us, int *x, int *y)
+{
+    if (s_hist_n && t_us - s_hist[s_hist_n - 1].t_us > PT_LVGL_TOUCH_PREDICT_GAP_US)
+        s_hist_n = 0;
+    if (s_hist_n && t_us <= s_hist[s_hist_n - 1].t_us)
+        return;
+    if (s_hist_n == 3)
+    {
+        s_hist[0] = s_hist[1];
+        s_hist[1] = s_hist[2];
+        s_hist_n = 2;
+    }
+    s_hist[s_hist_n++] = (pt_lvgl_touch_sample_t){.x = *x, .y = *y, .t_us = t_us};
+
+    const uint16_t horizon_ms = s_predict_ms;
+    if (!horizon_ms || s_hist_n < 2)
+        return;
+
+    const pt_lvgl_touch_sample_t *b = &s_hist[s_hist_n - 2];
+    const pt_lvgl_touch_sample_t *c = &s_hist[s_hist_n - 1];
+    const float dt2 = (float)(c->t_us - b->t_us) / 1000.0f;
+    const float vx = (float)(c->x - b->x) / dt2;
+    const float vy = (float)(c->y - b->y) / dt2;
+    float ax = 0.0f, ay = 0.0f;
+    if (s_hist_n == 3)
+    {
+        const pt_lvgl_touch_sample_t *a = &s_hist[0];
+        const float dt1 = (float)(b->t_us - a->t_us) / 1000.0f;
+        const float ux = (float)(b->x - a->x) / dt1;
+        const float uy = (float)(b->y - a->y) / dt1;
+        if (ux * vx < 0.0f || uy * vy < 0.0f)
+        {
+            // Direction reversal: history before the turn is meaningless, report the measured point
+            s_hist[0] = *b;
+            s_hist[1] = *c;
+            s_hist_n = 2;
+            return;
+        }
+        ax = (vx - ux) * 2.0f / (dt1 + dt2);
+        ay = (vy - uy) * 2.0f / (dt1 + dt2);
+    }
+
+    // Target: when the frame rendered now reaches the panel, measured from the sample time
+    const float h = (float)(esp_timer_get_time() - c->t_us) / 1000.0f + horizon_ms;
+    *x = pt_lvgl_touch_predict_axis(c->x, vx, ax, h, s_ctx.scr_w);
+    *y = pt_lvgl_touch_predict_axis(c->y, vy, ay, h, s_ctx.scr_h);
+}
+#endif
+
+#ifdef CONFIG_PT_LVGL_TOUCH_MULTI
+/* Multi-touch: one slot per GT911 track id, so frames are matched without searching or sorting */
+#define PT_LVGL_TOUCH_TRACKS 16 // GT911 track ids are 4 bits
+
+typedef struct
+{
+    int x, y; // last mapped point of this track
+} pt_lvgl_touch_track_t;
+
+static pt_lvgl_touch_track_t s_tracks[PT_LVGL_TOUCH_TRACKS];
+static uint16_t s_track_mask = 0; // bit per track currently down
+static int8_t s_primary = -1;     // track driving the LVGL pointer (-1: none)
+
+/* Update the slot table from one frame; returns whether the pointer is down and its point */
+static bool pt_lvgl_touch_track_frame(const pt_touch_event_t *ev, int *x, int *y)
+{
+    uint16_t seen = 0;
+#if LV_USE_GESTURE_RECOGNITION
+    lv_indev_touch_data_t touches[PT_LVGL_TOUCH_TRACKS];
+    uint16_t n = 0;
+    const uint32_t now = lv_tick_get();
+#endif
+
+    for (uint8_t i = 0; i < ev->number && i < PT_GT911_MAX_POINTS; i++)
+    {
+        const uint8_t id = ev->point[i].track_id & (PT_LVGL_TOUCH_TRACKS - 1);
+        if (seen & (1u << id))
+            continue;
+        seen |= 1u << id;
+        pt_lvgl_touch_track_t *t = &s_tracks[id];
+        pt_lvgl_touch_map_point(ev->point[i].x, ev->point[i].y, &t->x, &t->y);
+        // A finger landing while no track owns the pointer takes it over
+        if (s_primary < 0 && !(s_track_mask & (1u << id)))
+            s_primary = id;
+        if (id == s_primary)
+        {
+            s_ctx.raw_x = ev->point[i].x;
+            s_ctx.raw_y = ev->point[i].y;
+        }
+#if LV_USE_GESTURE_RECOGNITION
+        touches[n++] = (lv_indev_touch_data_t){
+            .point = {.x = t->x, .y = t->y}, .state = LV_INDEV_STATE_PRESSED, .id = id, .timestamp = now};
+#endif
+    }
+
+    // Tracks missing from this frame lifted; the pointer is not handed to a remaining finger
+    uint16_t lifted = s_track_mask & ~seen;
+    while (lifted)
+    {
+        const uint8_t id = __builtin_ctz(lifted);
+        lifted &= lifted - 1;
+        if (id == s_primary)
+            s_primary = -1;
+#if LV_USE_GESTURE_RECOGNITION
+        touches[n++] = (lv_indev_touch_data_t){
+            .point = {.x = s_tracks[id].x, .y = s_tracks[id].y}, .state = LV_INDEV_STATE_RELEASED, .id = id, .timestamp = now};
+#endif
+    }
+    s_track_mask = seen;
+
+#if LV_USE_GESTURE_RECOGNITION
+    if (n)
+        lv_indev_gesture_recognizers_update(s_indev, touches, n);
+#endif
+
+    if (s_primary < 0)
+        return false;
+    *x = s_tracks[s_primary].x;
+    *y = s_tracks[s_primary].y;
+    return true;
+}
+
+/* Controller went silent: lift every track */
+static void pt_lvgl_touch_track_release_all(void)
+{
+    static const pt_touch_event_t none = {0};
+    int x, y;
+    if (s_track_mask)
+        pt_lvgl_touch_track_frame(&none, &x, &y);
+}
+#endif
+
 /* LVGL read callback (v9 API) */
 static void pt_lvgl_touch_read_cb(lv_indev_t *indev, lv_indev_data_t *data)
 {
@@ -38,30 +476,357 @@ static void pt_lvgl_touch_read_cb(lv_indev_t *indev, lv_indev_data_t *data)
     (void)indev;
     data->continue_reading = false;
 
-    if (!pt_touch_i2c_ready())
+    pt_touch_event_t ev;
+    bool fresh;
+#ifdef CONFIG_PT_TOUCH_REPLAY
+    const bool replaying = pt_touch_replay_active();
+    if (replaying)
     {
-        data->state = LV_INDEV_STATE_RELEASED;
-        return;
+        // The trace stands in for the controller; live frames are discarded meanwhile
+        bool more;
+        while (s_use_task && pt_touch_pop_event(&ev))
+            ;
+        fresh = pt_touch_replay_next(&ev, &more);
+        data->continue_reading = more;
     }
-
-    pt_touch_event_t ev;
-    if (!pt_touch_get_touch(&ev) || ev.number == 0)
+    else
+#endif
+    if (s_use_task)
     {
-        data->state = LV_INDEV_STATE_RELEASED;
+        // No I2C here: the sampling task already read the frame
+        fresh = pt_touch_pop_event(&ev);
+        data->continue_reading = fresh && pt_touch_pending_events() > 0;
+    }
+    else
+    {
+        fresh = pt_touch_get_touch(&ev);
+    }
+#ifdef CONFIG_PT_TOUCH_REPLAY
+    if (fresh && !replaying)
+        pt_touch_record_frame(&ev);
+#endif
+    pt_touch_stats_note_read(fresh ? &ev : NULL);
+    if (fresh)
+        pt_display_note_input(ev.timestamp_us);
+    if (!fresh)
+    {
+        // No new frame: hold the last state unless the controller went silent
+        if (s_ctx.last_state == LV_INDEV_STATE_PRESSED && lv_tick_elaps(s_ctx.last_fresh_ms) > PT_LVGL_TOUCH_STALE_MS)
+        {
+            s_ctx.last_state = LV_INDEV_STATE_RELEASED;
+#ifdef CONFIG_PT_LVGL_TOUCH_MULTI
+            pt_lvgl_touch_track_release_all();
+#endif
+        }
+#ifdef CONFIG_PT_LVGL_TOUCH_FILTER
+        if (s_ctx.last_state == LV_INDEV_STATE_PRESSED && pt_lvgl_touch_filter_release_due())
+            s_ctx.last_state = LV_INDEV_STATE_RELEASED;
+        if (s_ctx.last_state == LV_INDEV_STATE_RELEASED && s_fs.down)
+            pt_lvgl_touch_filter_reset();
+#endif
+        data->point.x = s_ctx.last_x;
+        data->point.y = s_ctx.last_y;
+#ifdef CONFIG_PT_LVGL_TOUCH_PREDICT
+        if (s_ctx.last_state == LV_INDEV_STATE_RELEASED)
+        {
+            s_hist_n = 0;
+        }
+        else if (s_hist_n)
+        {
+            // Still down: keep showing the predicted point until the next frame
+            data->point.x = s_pred_x;
+            data->point.y = s_pred_y;
+        }
+#endif
+        data->state = s_ctx.last_state;
+#if defined(CONFIG_PT_LVGL_TOUCH_MULTI) && LV_USE_GESTURE_RECOGNITION
+        lv_indev_gesture_recognizers_set_data(indev, data);
+#endif
         return;
     }
 
-    // Use the first point; extend to multi-touch if needed
-    int mx, my;
-    pt_lvgl_touch_map_point(ev.point[0].x, ev.point[0].y, &mx, &my);
-    data->point.x = mx;
-    data->point.y = my;
-    data->state = LV_INDEV_STATE_PRESSED;
+    s_ctx.last_fresh_ms = lv_tick_get();
+
+    int mx = s_ctx.last_x, my = s_ctx.last_y;
+#ifdef CONFIG_PT_LVGL_TOUCH_MULTI
+    bool pressed = pt_lvgl_touch_track_frame(&ev, &mx, &my);
+#else
+    // Use the first point
+    bool pressed = ev.number > 0;
+    if (pressed)
+    {
+        s_ctx.raw_x = ev.point[0].x;
+        s_ctx.raw_y = ev.point[0].y;
+        pt_lvgl_touch_map_point(ev.point[0].x, ev.point[0].y, &mx, &my);
+    }
+#endif
+#ifdef CONFIG_PT_LVGL_TOUCH_FILTER
+    pressed = pt_lvgl_touch_filter_frame(pressed, &mx, &my);
+#endif
+    // last_x/last_y keep the measured point: a release is reported where the finger actually was
+    data->point.x = s_ctx.last_x = mx;
+    data->point.y = s_ctx.last_y = my;
+#ifdef CONFIG_PT_LVGL_TOUCH_PREDICT
+    if (pressed)
+    {
+        pt_lvgl_touch_predict(ev.timestamp_us, &mx, &my);
+        data->point.x = s_pred_x = mx;
+        data->point.y = s_pred_y = my;
+    }
+    else
+    {
+        s_hist_n = 0;
+    }
+#endif
+    data->state = s_ctx.last_state = pressed ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+#if defined(CONFIG_PT_LVGL_TOUCH_MULTI) && LV_USE_GESTURE_RECOGNITION
+    lv_indev_gesture_recognizers_set_data(indev, data);
+#endif
 
     // ESP_LOGI(TAG, "PT GT911 LVGL indev e %d,%d", ev.point[0].x, ev.point[0].y);
     // ESP_LOGI(TAG, "PT GT911 LVGL indev M %d,%d", mx, my);
 }
 
+#ifdef CONFIG_PT_LVGL_TOUCH_INT_WAKE
+static void IRAM_ATTR pt_lvgl_touch_int_cb(void *arg)
+{
+    (void)arg;
+    s_int_pending = true;
+    pt_display_wake();
+}
+#endif
+
+
+void pt_lvgl_touch_process(void)
+{
+    if (!s_int_pending || !s_indev)
+        return;
+    s_int_pending = false;
+    lv_indev_read(s_indev);
+}
+
+void pt_lvgl_touch_frame_sync(void)
+{
+    if (!s_indev)
+        return;
+    // Event mode: take what arrived since the task pass started; polling: sample the controller now
+    if (!s_event_mode || s_int_pending)
+    {
+        s_int_pending = false;
+        lv_indev_read(s_indev);
+    }
+}
+
+esp_err_t pt_lvgl_touch_set_filter(const pt_lvgl_touch_filter_t *cfg)
+{
+#ifdef CONFIG_PT_LVGL_TOUCH_FILTER
+    if (!cfg || cfg->press_frames < 1 || cfg->ema_alpha_q8 < 1 || cfg->ema_alpha_q8 > 256)
+        return ESP_ERR_INVALID_ARG;
+    PT_LVGL_SCOPE_LOCK()
+    {
+        s_filt = *cfg;
+        pt_lvgl_touch_filter_reset();
+    }
+    return ESP_OK;
+#else
+    (void)cfg;
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+void pt_lvgl_touch_get_filter(pt_lvgl_touch_filter_t *out)
+{
+    if (!out)
+        return;
+#ifdef CONFIG_PT_LVGL_TOUCH_FILTER
+    *out = s_filt;
+#else
+    memset(out, 0, sizeof(*out));
+#endif
+}
+
+esp_err_t pt_lvgl_touch_set_predict_ms(uint16_t horizon_ms)
+{
+#ifdef CONFIG_PT_LVGL_TOUCH_PREDICT
+    if (horizon_ms > 100)
+        return ESP_ERR_INVALID_ARG;
+    s_predict_ms = horizon_ms;
+    return ESP_OK;
+#else
+    (void)horizon_ms;
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+uint16_t pt_lvgl_touch_get_predict_ms(void)
+{
+#ifdef CONFIG_PT_LVGL_TOUCH_PREDICT
+    return s_predict_ms;
+#else
+    return 0;
+#endif
+}
+
+esp_err_t pt_lvgl_touch_set_orientation(uint8_t flags)
+{
+    if (flags & ~(PT_LVGL_TOUCH_ORIENT_SWAP_XY | PT_LVGL_TOUCH_ORIENT_INVERT_X | PT_LVGL_TOUCH_ORIENT_INVERT_Y))
+        return ESP_ERR_INVALID_ARG;
+    PT_LVGL_SCOPE_LOCK()
+    {
+        s_ctx.orient = flags;
+        pt_lvgl_touch_update_transform();
+    }
+    return ESP_OK;
+}
+
+uint8_t pt_lvgl_touch_get_orientation(void)
+{
+    return s_ctx.orient;
+}
+
+bool pt_lvgl_touch_get_raw(int *x, int *y)
+{
+    if (x)
+        *x = s_ctx.raw_x;
+    if (y)
+        *y = s_ctx.raw_y;
+    return s_ctx.last_state == LV_INDEV_STATE_PRESSED;
+}
+
+esp_err_t pt_lvgl_touch_calibrate(const pt_lvgl_touch_cal_point_t *pts, size_t n,
+                                  pt_lvgl_touch_matrix_t *out, float *max_err_px)
+{
+    if (!pts || n < 3 || !out)
+        return ESP_ERR_INVALID_ARG;
+    if (!s_indev)
+        return ESP_ERR_INVALID_STATE;
+
+    // Least squares on centred data: a 2x2 solve per output axis, offsets from the means
+    double mx = 0, my = 0, mu = 0, mv = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        double u, v;
+        pt_lvgl_touch_to_native(pts[i].scr_x, pts[i].scr_y, &u, &v);
+        mx += pts[i].raw_x;
+        my += pts[i].raw_y;
+        mu += u;
+        mv += v;
+    }
+    mx /= n;
+    my /= n;
+    mu /= n;
+    mv /= n;
+
+    double sxx = 0, sxy = 0, syy = 0, sxu = 0, syu = 0, sxv = 0, syv = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        double u, v;
+        pt_lvgl_touch_to_native(pts[i].scr_x, pts[i].scr_y, &u, &v);
+        const double dx = pts[i].raw_x - mx, dy = pts[i].raw_y - my;
+        sxx += dx * dx;
+        sxy += dx * dy;
+        syy += dy * dy;
+        sxu += dx * (u - mu);
+        syu += dy * (u - mu);
+        sxv += dx * (v - mv);
+        syv += dy * (v - mv);
+    }
+    const double det = sxx * syy - sxy * sxy;
+    if (det <= 1e-9 * sxx * syy || det == 0.0)
+        return ESP_ERR_INVALID_ARG; // points (nearly) collinear
+
+    const double a = (syy * sxu - sxy * syu) / det;
+    const double b = (sxx * syu - sxy * sxu) / det;
+    const double d = (syy * sxv - sxy * syv) / det;
+    const double e = (sxx * syv - sxy * sxv) / det;
+    out->a = (int32_t)lround(a * 65536.0);
+    out->b = (int32_t)lround(b * 65536.0);
+    out->c = (int32_t)lround((mu - a * mx - b * my) * 65536.0);
+    out->d = (int32_t)lround(d * 65536.0);
+    out->e = (int32_t)lround(e * 65536.0);
+    out->f = (int32_t)lround((mv - d * mx - e * my) * 65536.0);
+
+    if (max_err_px)
+    {
+        // Residual through the fixed-point matrix, as the mapper will apply it
+        double worst = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            double u, v;
+            pt_lvgl_touch_to_native(pts[i].scr_x, pts[i].scr_y, &u, &v);
+            const double px = ((double)out->a * pts[i].raw_x + (double)out->b * pts[i].raw_y + out->c) / 65536.0;
+            const double py = ((double)out->d * pts[i].raw_x + (double)out->e * pts[i].raw_y + out->f) / 65536.0;
+            const double err = hypot(px - u, py - v);
+            if (err > worst)
+                worst = err;
+        }
+        *max_err_px = (float)worst;
+    }
+    return ESP_OK;
+}
+
+esp_err_t pt_lvgl_touch_set_matrix(const pt_lvgl_touch_matrix_t *m)
+{
+    PT_LVGL_SCOPE_LOCK()
+    {
+        s_ctx.calibrated = (m != NULL);
+        if (m)
+            s_ctx.m = *m;
+        pt_lvgl_touch_update_transform();
+    }
+    return ESP_OK;
+}
+
+void pt_lvgl_touch_get_matrix(pt_lvgl_touch_matrix_t *out)
+{
+    if (!out)
+        return;
+    PT_LVGL_SCOPE_LOCK()
+    {
+        *out = s_ctx.m;
+    }
+}
+
+esp_err_t pt_lvgl_touch_save_calibration(void)
+{
+#ifdef CONFIG_PT_LVGL_TOUCH_CAL_NVS
+    if (!s_ctx.calibrated)
+        return ESP_ERR_INVALID_STATE;
+    pt_lvgl_touch_cal_blob_t blob = {.magic = PT_LVGL_TOUCH_CAL_MAGIC};
+    PT_LVGL_SCOPE_LOCK()
+    {
+        blob.scr_w = (uint16_t)s_ctx.scr_w;
+        blob.scr_h = (uint16_t)s_ctx.scr_h;
+        blob.m = s_ctx.m;
+    }
+    nvs_handle_t h;
+    ESP_RETURN_ON_ERROR(nvs_open(PT_LVGL_TOUCH_NVS_NS, NVS_READWRITE, &h), TAG, "nvs_open failed");
+    esp_err_t err = nvs_set_blob(h, PT_LVGL_TOUCH_NVS_KEY, &blob, sizeof(blob));
+    if (err == ESP_OK)
+        err = nvs_commit(h);
+    nvs_close(h);
+    return err;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+esp_err_t pt_lvgl_touch_erase_calibration(void)
+{
+    pt_lvgl_touch_set_matrix(NULL);
+#ifdef CONFIG_PT_LVGL_TOUCH_CAL_NVS
+    nvs_handle_t h;
+    ESP_RETURN_ON_ERROR(nvs_open(PT_LVGL_TOUCH_NVS_NS, NVS_READWRITE, &h), TAG, "nvs_open failed");
+    esp_err_t err = nvs_erase_key(h, PT_LVGL_TOUCH_NVS_KEY);
+    if (err == ESP_OK)
+        err = nvs_commit(h);
+    nvs_close(h);
+    return err == ESP_ERR_NVS_NOT_FOUND ? ESP_OK : err;
+#else
+    return ESP_OK;
+#endif
+}
+
 /* Public init */
 lv_indev_t *pt_lvgl_touch_init(lv_display_t *disp,
                                int tp_w, int tp_h)
@@ -81,14 +846,22 @@ lv_indev_t *pt_lvgl_touch_init(lv_display_t *disp,
         ESP_LOGE(TAG, "No LVGL display found. Create a display first.");
         return NULL;
     }
-    lv_coord_t hor = lv_display_get_horizontal_resolution(use_disp);
-    lv_coord_t ver = lv_display_get_vertical_resolution(use_disp);
-
-    // Save mapping context
-    s_ctx.tp_w = (tp_w > 0) ? tp_w : PT_GT911_MAX_X;
-    s_ctx.tp_h = (tp_h > 0) ? tp_h : PT_GT911_MAX_Y;
-    s_ctx.scr_w = hor;
-    s_ctx.scr_h = ver;
+    // Save mapping context; without explicit sizes use the controller's configured output range
+    pt_touch_gt911_config_t gt_cfg;
+    const bool have_cfg = (tp_w <= 0 || tp_h <= 0) && pt_touch_config_read(&gt_cfg) == ESP_OK;
+    s_ctx.tp_w = (tp_w > 0) ? tp_w : (have_cfg ? gt_cfg.x_max : PT_GT911_MAX_X);
+    s_ctx.tp_h = (tp_h > 0) ? tp_h : (have_cfg ? gt_cfg.y_max : PT_GT911_MAX_Y);
+    s_ctx.orient = 0
+#ifdef CONFIG_PT_LVGL_TOUCH_SWAP_XY
+                   | PT_LVGL_TOUCH_ORIENT_SWAP_XY
+#endif
+#ifdef CONFIG_PT_LVGL_TOUCH_INVERT_X
+                   | PT_LVGL_TOUCH_ORIENT_INVERT_X
+#endif
+#ifdef CONFIG_PT_LVGL_TOUCH_INVERT_Y
+                   | PT_LVGL_TOUCH_ORIENT_INVERT_Y
+#endif
+        ;
 
     // Create input device (LVGL v9 object API)
     lv_indev_t *indev = lv_indev_create();
@@ -100,6 +873,45 @@ lv_indev_t *pt_lvgl_touch_init(lv_display_t *disp,
     lv_indev_set_type(indev, LV_INDEV_TYPE_POINTER);
     lv_indev_set_read_cb(indev, pt_lvgl_touch_read_cb);
     lv_indev_set_disp(indev, use_disp);
+    s_indev = indev;
+
+    // Mapping: native panel resolution, stored calibration or scale + orientation; follow rotation
+    pt_lvgl_touch_update_transform();
+#ifdef CONFIG_PT_LVGL_TOUCH_CAL_NVS
+    pt_lvgl_touch_load_calibration();
+    pt_lvgl_touch_update_transform();
+#endif
+    lv_display_add_event_cb(use_disp, pt_lvgl_touch_disp_event_cb, LV_EVENT_RESOLUTION_CHANGED, NULL);
+
+#ifdef CONFIG_PT_LVGL_TOUCH_FILTER
+    const esp_timer_create_args_t rel_args = {
+        .callback = pt_lvgl_touch_request_read,
+        .name = "pt_touch_rel",
+    };
+    if (!s_release_timer && esp_timer_create(&rel_args, &s_release_timer) != ESP_OK)
+    {
+        s_release_timer = NULL;
+        ESP_LOGW(TAG, "release debounce timer unavailable; lifts are reported immediately");
+    }
+#endif
+
+#ifdef CONFIG_PT_TOUCH_REPLAY
+    pt_touch_replay_set_notify(pt_lvgl_touch_request_read, NULL);
+#endif
+
+#ifdef CONFIG_PT_LVGL_TOUCH_INT_WAKE
+    // Read on INT edges only so the LVGL task can sleep while nobody touches the screen
+#ifdef CONFIG_PT_TOUCH_IRQ_TASK
+    s_use_task = (pt_touch_start_task(pt_lvgl_touch_request_read, NULL) == ESP_OK);
+    if (!s_use_task)
+        ESP_LOGW(TAG, "touch sampling task unavailable; reading from the LVGL task");
+#endif
+    s_event_mode = s_use_task || pt_touch_set_int_cb(pt_lvgl_touch_int_cb, NULL) == ESP_OK;
+    if (s_event_mode)
+        lv_indev_set_mode(indev, LV_INDEV_MODE_EVENT);
+    else
+        ESP_LOGW(TAG, "GT911 INT unavailable; falling back to polling");
+#endif
 
     ESP_LOGI(TAG, "PT GT911 LVGL indev registered (%ldx%ld touch -> %ldx%ld disp)",
              (long)s_ctx.tp_w, (long)s_ctx.tp_h, (long)s_ctx.scr_w, (long)s_ctx.scr_h);
@@ -12,7 +12,9 @@
 #include "freertos/queue.h"
 #include "esp_log.h"
 #include "esp_err.h"
+#include "esp_heap_caps.h"
 #include <inttypes.h>
+#include <limits.h>
 
 #include "usb/usb_host.h"     // IDF 5.1: usb_host_* + flags
 #include "usb/msc_host.h"     // IDF 5.1: MSC host core
@@ -157,6 +159,9 @@ void pt_usb_stop(void)
         (void)msc_host_vfs_unregister(s_vfs);
         s_vfs = NULL;
         s_mounted = false;
+#ifdef CONFIG_PT_LVGL_USE_PT_INTERNAL_STDIO
+        pt_lvgl_stdio_fs_cache_invalidate();
+#endif
     }
     if (s_dev)
     {
@@ -212,7 +217,43 @@ bool pt_usb_get_info(pt_usb_info_t *out)
     return s_mounted;
 }
 
+/* Entry collected while reading the directory; names are packed in a separate buffer */
+typedef struct
+{
+    uint32_t name_off;
+    uint32_t name_len;
+    bool is_dir;
+    bool has_size;
+    size_t size;
+} pt_usb_scan_ent_t;
+
+static bool pt_usb_grow(void **buf, size_t *cap, size_t need, size_t elem, size_t initial)
+{
+    if (need <= *cap)
+    {
+        return true;
+    }
+    size_t newcap = *cap == 0 ? initial : *cap;
+    while (newcap < need)
+    {
+        newcap *= 2;
+    }
+    void *tmp = realloc(*buf, newcap * elem);
+    if (!tmp)
+    {
+        return false;
+    }
+    *buf = tmp;
+    *cap = newcap;
+    return true;
+}
+
 pt_usb_dir_list_t *pt_usb_list_dir(const char *path, int *out_err)
+{
+    return pt_usb_list_dir_ex(path, PT_USB_LIST_SIZES, out_err);
+}
+
+pt_usb_dir_list_t *pt_usb_list_dir_ex(const char *path, uint32_t flags, int *out_err)
 {
     if (out_err)
     {
@@ -230,6 +271,7 @@ pt_usb_dir_list_t *pt_usb_list_dir(const char *path, int *out_err)
 
     char abs[256];
     pt_usb_make_abs(abs, sizeof(abs), path);
+    size_t abs_len = strlen(abs);
 
     DIR *d = opendir(abs);
     if (!d)
@@ -241,13 +283,14 @@ pt_usb_dir_list_t *pt_usb_list_dir(const char *path, int *out_err)
         return NULL;
     }
 
-    struct pt_collector
-    {
-        pt_usb_dir_entry_t *arr;
-        size_t count;
-        size_t cap;
-        int err;
-    } c = {NULL, 0, 0, 0};
+    // first pass: entry metadata and names go into two scratch buffers that only ever grow,
+    // so a large folder costs a handful of reallocs instead of two strdups per entry
+    pt_usb_scan_ent_t *ents = NULL;
+    size_t ent_count = 0, ent_cap = 0;
+    char *names = NULL;
+    size_t names_len = 0, names_cap = 0;
+    size_t paths_len = 0;
+    int err = 0;
 
     struct dirent *e;
     while ((e = readdir(d)) != NULL)
@@ -257,108 +300,144 @@ pt_usb_dir_list_t *pt_usb_list_dir(const char *path, int *out_err)
             continue;
         }
 
-        if (c.count + 1 > c.cap)
+        size_t name_len = strlen(e->d_name);
+        if (!pt_usb_grow((void **)&ents, &ent_cap, ent_count + 1, sizeof(*ents), 32) ||
+            !pt_usb_grow((void **)&names, &names_cap, names_len + name_len + 1, 1, 1024))
         {
-            size_t newcap = c.cap == 0 ? 8 : c.cap * 2;
-            pt_usb_dir_entry_t *tmp = realloc(c.arr, newcap * sizeof(pt_usb_dir_entry_t));
-            if (!tmp)
-            {
-                c.err = -ENOMEM;
-                break;
-            }
-            c.arr = tmp;
-            c.cap = newcap;
+            err = -ENOMEM;
+            break;
         }
 
-        char child[512];
-        snprintf(child, sizeof(child), "%s/%s", abs, e->d_name);
-        struct stat st;
-        bool ok = (stat(child, &st) == 0);
-        bool is_dir = ok && S_ISDIR(st.st_mode);
-        size_t size = ok ? (size_t)st.st_size : 0;
-
-        pt_usb_dir_entry_t *ent = &c.arr[c.count];
-        ent->name = strdup(e->d_name);
-        if (!ent->name)
+        pt_usb_scan_ent_t *ent = &ents[ent_count];
+        ent->name_off = (uint32_t)names_len;
+        ent->name_len = (uint32_t)name_len;
+        ent->is_dir = false;
+        ent->has_size = false;
+        ent->size = 0;
+
+        // FATFS fills d_type from the directory entry it just read; stat() would look the
+        // name up again, so it is only used for sizes or when the type is unknown
+        bool need_stat = (flags & PT_USB_LIST_SIZES) != 0;
+#if defined(DT_DIR) && defined(DT_REG)
+        if (e->d_type == DT_DIR)
         {
-            c.err = -ENOMEM;
-            break;
+            ent->is_dir = true;
         }
-        ent->path = strdup(child);
-        if (!ent->path)
+        else if (e->d_type != DT_REG)
         {
-            free(ent->name);
-            c.err = -ENOMEM;
-            break;
+            need_stat = true;
         }
-        ent->is_dir = is_dir;
-        ent->is_hidden = (ent->name[0] == '.');
-        ent->size = size;
-        c.count++;
-    }
-
-    closedir(d);
-
-    if (c.err != 0)
-    {
-        for (size_t i = 0; i < c.count; ++i)
+#else
+        need_stat = true;
+#endif
+        if (need_stat)
         {
-            free(c.arr[i].name);
-            free(c.arr[i].path);
+            char child[512];
+            snprintf(child, sizeof(child), "%s/%s", abs, e->d_name);
+            struct stat st;
+            if (stat(child, &st) == 0)
+            {
+                ent->is_dir = S_ISDIR(st.st_mode);
+                ent->size = ent->is_dir ? 0 : (size_t)st.st_size;
+                ent->has_size = true;
+            }
         }
-        free(c.arr);
-        if (out_err)
+        if (ent->is_dir)
         {
-            *out_err = c.err;
+            ent->has_size = true;
         }
-        return NULL;
+
+        memcpy(names + names_len, e->d_name, name_len + 1);
+        names_len += name_len + 1;
+        paths_len += abs_len + 1 + name_len + 1;
+        ent_count++;
     }
 
-    /* shrink-to-fit */
-    if (c.count < c.cap)
+    closedir(d);
+
+    pt_usb_dir_list_t *list = NULL;
+    if (err == 0)
     {
-        pt_usb_dir_entry_t *shrink = realloc(c.arr, c.count * sizeof(pt_usb_dir_entry_t));
-        if (shrink)
+        // second pass: list header, entries and strings in one block, released by a single free()
+        size_t total = sizeof(*list) + ent_count * sizeof(pt_usb_dir_entry_t) + names_len + paths_len;
+        list = malloc(total);
+        if (!list)
         {
-            c.arr = shrink;
+            err = -ENOMEM;
         }
     }
 
-    pt_usb_dir_list_t *list = malloc(sizeof(*list));
-    if (!list)
+    if (err != 0)
     {
-        for (size_t i = 0; i < c.count; ++i)
-        {
-            free(c.arr[i].name);
-        }
-        free(c.arr);
+        free(ents);
+        free(names);
         if (out_err)
         {
-            *out_err = -ENOMEM;
+            *out_err = err;
         }
         return NULL;
     }
 
-    list->entries = c.arr;
-    list->count = c.count;
+    list->entries = (pt_usb_dir_entry_t *)(list + 1);
+    list->count = ent_count;
+    char *str = (char *)(list->entries + ent_count);
+    for (size_t i = 0; i < ent_count; ++i)
+    {
+        const pt_usb_scan_ent_t *src = &ents[i];
+        pt_usb_dir_entry_t *ent = &list->entries[i];
+
+        ent->name = str;
+        memcpy(str, names + src->name_off, src->name_len + 1);
+        str += src->name_len + 1;
+
+        ent->path = str;
+        memcpy(str, abs, abs_len);
+        str[abs_len] = '/';
+        memcpy(str + abs_len + 1, ent->name, src->name_len + 1);
+        str += abs_len + 1 + src->name_len + 1;
+
+        ent->is_dir = src->is_dir;
+        ent->is_hidden = (ent->name[0] == '.');
+        ent->has_size = src->has_size;
+        ent->size = src->size;
+    }
+
+    free(ents);
+    free(names);
     return list;
 }
 
-void pt_usb_dir_list_free(pt_usb_dir_list_t *list)
+int pt_usb_dir_entry_size(pt_usb_dir_entry_t *ent, size_t *out_size)
 {
-    if (!list)
+    if (!ent || !ent->path)
     {
-        return;
+        return -EINVAL;
     }
-    if (list->entries)
+    if (!ent->has_size)
     {
-        for (size_t i = 0; i < list->count; ++i)
+        if (!s_mounted)
+        {
+            return -ENODEV;
+        }
+        struct stat st;
+        if (stat(ent->path, &st) != 0)
         {
-            free(list->entries[i].name);
-            free(list->entries[i].path);
+            return -errno;
         }
-        free(list->entries);
+        ent->is_dir = S_ISDIR(st.st_mode);
+        ent->size = ent->is_dir ? 0 : (size_t)st.st_size;
+        ent->has_size = true;
+    }
+    if (out_size)
+    {
+        *out_size = ent->size;
     }
+    return 0;
+}
+
+void pt_usb_dir_list_free(pt_usb_dir_list_t *list)
+{
+    // entries and strings live in the same allocation as the list
     free(list);
 }
 
@@ -529,6 +608,236 @@ int pt_usb_remove(const char *path)
     return (unlink(abs) == 0) ? 0 : -errno;
 }
 
+// ---- Streaming file handles ----
+
+struct pt_usb_file
+{
+    FILE *fp;
+    void *buf;     // stdio buffer (setvbuf), aligned
+    uint64_t pos;  // stdio position, so sequential calls skip the seek
+    bool writing;  // last operation was a write: a read must reposition first
+    bool append;
+};
+
+static int pt_usb_file_seek(pt_usb_file_t *f, uint64_t offset, bool for_write)
+{
+    // C requires a positioning call between a write and a following read (and vice versa)
+    if (offset == f->pos && for_write == f->writing)
+    {
+        return 0;
+    }
+    if (offset > (uint64_t)LONG_MAX)
+    {
+        return -EOVERFLOW;
+    }
+    if (fseek(f->fp, (long)offset, SEEK_SET) != 0)
+    {
+        return -errno;
+    }
+    f->pos = offset;
+    f->writing = for_write;
+    return 0;
+}
+
+int pt_usb_open(const char *path, uint32_t flags, size_t buf_size, uint32_t buf_caps, pt_usb_file_t **out)
+{
+    if (!out)
+    {
+        return -EINVAL;
+    }
+    *out = NULL;
+    if (!s_mounted)
+    {
+        return -ENODEV;
+    }
+    if (!path || !(flags & (PT_USB_O_READ | PT_USB_O_WRITE)))
+    {
+        return -EINVAL;
+    }
+    char abs[512];
+    pt_usb_make_abs(abs, sizeof(abs), path);
+
+    const bool rd = flags & PT_USB_O_READ;
+    const bool creates = flags & (PT_USB_O_CREATE | PT_USB_O_TRUNC | PT_USB_O_APPEND);
+    if (creates && (flags & PT_USB_O_WRITE))
+    {
+        pt_usb_ensure_parent_dirs(abs);
+    }
+
+    const char *mode = "rb";
+    if (flags & PT_USB_O_WRITE)
+    {
+        if (flags & PT_USB_O_APPEND)
+        {
+            mode = rd ? "a+b" : "ab";
+        }
+        else if (flags & PT_USB_O_TRUNC)
+        {
+            mode = rd ? "w+b" : "wb";
+        }
+        else
+        {
+            mode = "r+b";
+        }
+    }
+    FILE *fp = fopen(abs, mode);
+    if (!fp && errno == ENOENT && (flags & PT_USB_O_WRITE) && (flags & PT_USB_O_CREATE))
+    {
+        fp = fopen(abs, rd ? "w+b" : "wb");
+    }
+    if (!fp)
+    {
+        return -errno;
+    }
+
+    // Whole sectors, so large sequential transfers reach the MSC bulk pipe sector-aligned
+    size_t sz = buf_size ? buf_size : PT_USB_FILE_BUF_DEFAULT;
+    sz = (sz + 511) & ~(size_t)511;
+    void *buf = heap_caps_aligned_alloc(PT_USB_FILE_BUF_ALIGN, sz, buf_caps ? buf_caps : (MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA));
+    if (!buf && !buf_caps)
+    {
+        buf = heap_caps_aligned_alloc(PT_USB_FILE_BUF_ALIGN, sz, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    }
+    pt_usb_file_t *f = calloc(1, sizeof(*f));
+    if (!buf || !f)
+    {
+        heap_caps_free(buf);
+        free(f);
+        fclose(fp);
+        return -ENOMEM;
+    }
+    setvbuf(fp, buf, _IOFBF, sz);
+
+    f->fp = fp;
+    f->buf = buf;
+    f->append = flags & PT_USB_O_APPEND;
+    if (f->append)
+    {
+        // Appends land at the end whatever the offset; start reads from there too
+        long end = -1;
+        if (fseek(fp, 0, SEEK_END) == 0)
+        {
+            end = ftell(fp);
+        }
+        if (end < 0)
+        {
+            const int e = errno ? errno : EIO;
+            fclose(fp);
+            heap_caps_free(buf);
+            free(f);
+            return -e;
+        }
+        f->pos = (uint64_t)end;
+    }
+    *out = f;
+    return 0;
+}
+
+int pt_usb_pread(pt_usb_file_t *f, void *buf, size_t len, uint64_t offset, size_t *out_len)
+{
+    if (out_len)
+    {
+        *out_len = 0;
+    }
+    if (!f || (!buf && len))
+    {
+        return -EINVAL;
+    }
+    if (!s_mounted)
+    {
+        return -ENODEV;
+    }
+    int e = pt_usb_file_seek(f, offset, false);
+    if (e != 0)
+    {
+        return e;
+    }
+    const size_t r = fread(buf, 1, len, f->fp);
+    f->pos += r;
+    if (out_len)
+    {
+        *out_len = r;
+    }
+    if (r < len && ferror(f->fp))
+    {
+        clearerr(f->fp);
+        return -EIO;
+    }
+    clearerr(f->fp); // EOF is reported through a short *out_len
+    return 0;
+}
+
+int pt_usb_pwrite(pt_usb_file_t *f, const void *buf, size_t len, uint64_t offset, size_t *out_len)
+{
+    if (out_len)
+    {
+        *out_len = 0;
+    }
+    if (!f || (!buf && len))
+    {
+        return -EINVAL;
+    }
+    if (!s_mounted)
+    {
+        return -ENODEV;
+    }
+    // In append mode the stream ignores the position; keep our copy in sync with the end
+    int e = pt_usb_file_seek(f, f->append ? f->pos : offset, true);
+    if (e != 0)
+    {
+        return e;
+    }
+    const size_t w = fwrite(buf, 1, len, f->fp);
+    f->pos += w;
+    if (out_len)
+    {
+        *out_len = w;
+    }
+    if (w < len)
+    {
+        clearerr(f->fp);
+        return -EIO;
+    }
+    return 0;
+}
+
+int pt_usb_size(pt_usb_file_t *f, uint64_t *out_size)
+{
+    if (!f || !out_size)
+    {
+        return -EINVAL;
+    }
+    if (!s_mounted)
+    {
+        return -ENODEV;
+    }
+    // Buffered writes are not visible to fstat yet
+    if (f->writing && fflush(f->fp) != 0)
+    {
+        return -errno;
+    }
+    struct stat st;
+    if (fstat(fileno(f->fp), &st) != 0)
+    {
+        return -errno;
+    }
+    *out_size = (uint64_t)st.st_size;
+    return 0;
+}
+
+int pt_usb_close(pt_usb_file_t *f)
+{
+    if (!f)
+    {
+        return -EINVAL;
+    }
+    // After an unmount the FILE still owns memory; fclose releases it (the flush just fails)
+    int e = (fclose(f->fp) == 0) ? 0 : -errno;
+    heap_caps_free(f->buf);
+    free(f);
+    return s_mounted ? e : -ENODEV;
+}
+
 // ---- File helpers ----
 
 static void pt_usb_make_abs(char *dst, size_t dstsz, const char *rel_or_abs)
@@ -633,6 +942,9 @@ static void pt_usb_unmount_vfs(void)
     s_mounted = false;
     s_info.state = PT_USB_STATE_WAITING_DEVICE;
     ESP_LOGW(TAG, "Unmounted %s", PT_USB_MOUNT_PATH);
+#ifdef CONFIG_PT_LVGL_USE_PT_INTERNAL_STDIO
+    pt_lvgl_stdio_fs_cache_invalidate();
+#endif
     if (s_on_unmount_cb)
         s_on_unmount_cb();
 }
@@ -7,6 +7,10 @@
 #include "driver/i2c_master.h"
 #include "esp_log.h"
 #include "esp_check.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "sdkconfig.h"
 
 /* --------- Logging --------- */
 static const char *TAG = "PandaTouch::Touch";
@@ -15,6 +19,87 @@ static const char *TAG = "PandaTouch::Touch";
 static i2c_master_bus_handle_t pt_i2c_bus = NULL;
 static i2c_master_dev_handle_t pt_i2c_dev = NULL;
 
+/* --------- Timeouts / recovery --------- */
+#define PT_TOUCH_I2C_TIMEOUT_MS CONFIG_PT_TOUCH_I2C_TIMEOUT_MS
+#define PT_TOUCH_ERRORS_BEFORE_RECOVERY 3
+#define PT_TOUCH_BACKOFF_MIN_MS 50
+static uint8_t pt_i2c_addr = 0;
+static volatile bool pt_recovering = false;
+static pt_touch_health_t pt_health = {0};
+static portMUX_TYPE pt_health_mux = portMUX_INITIALIZER_UNLOCKED;
+
+/* --------- INT line --------- */
+static pt_touch_int_cb_t pt_int_cb = NULL;
+static void *pt_int_cb_arg = NULL;
+
+/* --------- Sampling task + event ring --------- */
+#ifndef CONFIG_PT_TOUCH_EVENT_QUEUE_LEN
+#define CONFIG_PT_TOUCH_EVENT_QUEUE_LEN 8
+#endif
+static TaskHandle_t pt_touch_task_handle = NULL;
+static volatile int64_t pt_int_edge_us = 0; /* first INT edge not yet consumed by the task */
+static pt_touch_event_cb_t pt_event_cb = NULL;
+static void *pt_event_cb_arg = NULL;
+static pt_touch_event_t *pt_ring = NULL;
+static uint32_t pt_ring_head = 0; /* next slot to write (free-running) */
+static uint32_t pt_ring_tail = 0; /* next slot to read (free-running) */
+static portMUX_TYPE pt_ring_mux = portMUX_INITIALIZER_UNLOCKED;
+
+/* --------- Statistics --------- */
+#ifdef CONFIG_PT_TOUCH_STATS
+static pt_touch_stats_t pt_stats = {0};
+static int64_t pt_stats_start_us = 0;
+static TaskHandle_t pt_stats_lvgl_task = NULL; /* task running the input glue's read callback */
+static portMUX_TYPE pt_stats_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static void pt_stats_lat_add(pt_touch_latency_t *lat, int64_t us)
+{
+    const uint32_t v = us < 0 ? 0 : (us > UINT32_MAX ? UINT32_MAX : (uint32_t)us);
+    uint32_t bucket = v ? 32 - __builtin_clz(v) : 0;
+    if (bucket >= PT_TOUCH_LAT_BUCKETS)
+        bucket = PT_TOUCH_LAT_BUCKETS - 1;
+    lat->count++;
+    lat->total_us += v;
+    lat->hist[bucket]++;
+    if (v > lat->max_us)
+        lat->max_us = v;
+}
+
+static void pt_stats_i2c(uint32_t transactions, size_t bytes, esp_err_t err)
+{
+    const bool on_lvgl = pt_stats_lvgl_task && xTaskGetCurrentTaskHandle() == pt_stats_lvgl_task;
+    portENTER_CRITICAL(&pt_stats_mux);
+    pt_stats.i2c_transactions += transactions;
+    pt_stats.i2c_bytes += bytes;
+    if (err != ESP_OK)
+        pt_stats.i2c_errors++;
+    if (on_lvgl)
+        pt_stats.lvgl_transactions += transactions;
+    portEXIT_CRITICAL(&pt_stats_mux);
+}
+
+static void pt_stats_frame(bool fresh, int64_t t0, int64_t t1)
+{
+    portENTER_CRITICAL(&pt_stats_mux);
+    if (fresh)
+    {
+        pt_stats.frames++;
+        pt_stats_lat_add(&pt_stats.frame_read, t1 - t0);
+    }
+    else
+    {
+        pt_stats.empty_reads++;
+    }
+    portEXIT_CRITICAL(&pt_stats_mux);
+}
+
+#define PT_STATS_I2C(txns, bytes, err) pt_stats_i2c((txns), (bytes), (err))
+#define PT_STATS_NOW() esp_timer_get_time()
+#else
+#define PT_STATS_I2C(txns, bytes, err) ((void)0)
+#define PT_STATS_NOW() 0
+#endif
+
 /* --------- Helpers --------- */
 static inline void pt_touch_cfg_out(int gpio, int level)
 {
@@ -60,30 +145,83 @@ static void pt_touch_addr_select(bool choose_5D)
 #endif
 }
 
+static void IRAM_ATTR pt_touch_int_isr(void *arg)
+{
+    (void)arg;
+    if (pt_touch_task_handle)
+    {
+        portENTER_CRITICAL_ISR(&pt_ring_mux);
+        if (pt_int_edge_us == 0)
+            pt_int_edge_us = esp_timer_get_time();
+        portEXIT_CRITICAL_ISR(&pt_ring_mux);
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(pt_touch_task_handle, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+    if (pt_int_cb)
+        pt_int_cb(pt_int_cb_arg);
+}
+
+/* (Re)arm the INT edge interrupt; the address-select reset reconfigures the pin */
+static esp_err_t pt_touch_int_arm(void)
+{
+#if (PT_GT911_INT_GPIO >= 0)
+    gpio_config_t io = {
+        .pin_bit_mask = 1ULL << PT_GT911_INT_GPIO,
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_ENABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_ANYEDGE}; /* trigger polarity depends on the GT911 config block */
+    ESP_RETURN_ON_ERROR(gpio_config(&io), TAG, "int cfg");
+    esp_err_t err = gpio_install_isr_service(0);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) /* already installed */
+        return err;
+    ESP_RETURN_ON_ERROR(gpio_isr_handler_add(PT_GT911_INT_GPIO, pt_touch_int_isr, NULL), TAG, "int isr");
+    return ESP_OK;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
 /* --------- Low-level I2C (16-bit regs) --------- */
 static esp_err_t pt_touch_i2c_read(uint16_t reg, void *buf, size_t len)
 {
     uint8_t reg_be[2] = {(uint8_t)(reg >> 8), (uint8_t)reg};
 
     // Try repeated-start
-    esp_err_t err = i2c_master_transmit_receive(pt_i2c_dev, reg_be, 2, buf, len, -1);
+    esp_err_t err = i2c_master_transmit_receive(pt_i2c_dev, reg_be, 2, buf, len, PT_TOUCH_I2C_TIMEOUT_MS);
+    PT_STATS_I2C(1, 2 + len, err);
     if (err == ESP_OK)
         return ESP_OK;
+    if (err == ESP_ERR_TIMEOUT)
+        return err; // hung bus or controller: retrying only doubles the stall
 
     // Fallback: STOP between write & read
-    ESP_RETURN_ON_ERROR(i2c_master_transmit(pt_i2c_dev, reg_be, 2, -1), TAG, "tx reg");
-    return i2c_master_receive(pt_i2c_dev, buf, len, -1);
+#ifdef CONFIG_PT_TOUCH_STATS
+    portENTER_CRITICAL(&pt_stats_mux);
+    pt_stats.i2c_fallbacks++;
+    portEXIT_CRITICAL(&pt_stats_mux);
+#endif
+    err = i2c_master_transmit(pt_i2c_dev, reg_be, 2, PT_TOUCH_I2C_TIMEOUT_MS);
+    PT_STATS_I2C(1, 2, err);
+    ESP_RETURN_ON_ERROR(err, TAG, "tx reg");
+    err = i2c_master_receive(pt_i2c_dev, buf, len, PT_TOUCH_I2C_TIMEOUT_MS);
+    PT_STATS_I2C(1, len, err);
+    return err;
 }
 
 static esp_err_t pt_touch_i2c_write(uint16_t reg, const void *buf, size_t len)
 {
+    esp_err_t err;
     uint8_t stackbuf[2 + 16];
     if (len <= sizeof(stackbuf) - 2)
     {
         stackbuf[0] = (uint8_t)(reg >> 8);
         stackbuf[1] = (uint8_t)reg;
         memcpy(&stackbuf[2], buf, len);
-        return i2c_master_transmit(pt_i2c_dev, stackbuf, 2 + len, -1);
+        err = i2c_master_transmit(pt_i2c_dev, stackbuf, 2 + len, PT_TOUCH_I2C_TIMEOUT_MS);
+        PT_STATS_I2C(1, 2 + len, err);
+        return err;
     }
     uint8_t *p = (uint8_t *)malloc(2 + len);
     if (!p)
@@ -91,11 +229,229 @@ static esp_err_t pt_touch_i2c_write(uint16_t reg, const void *buf, size_t len)
     p[0] = (uint8_t)(reg >> 8);
     p[1] = (uint8_t)reg;
     memcpy(&p[2], buf, len);
-    esp_err_t err = i2c_master_transmit(pt_i2c_dev, p, 2 + len, -1);
+    err = i2c_master_transmit(pt_i2c_dev, p, 2 + len, PT_TOUCH_I2C_TIMEOUT_MS);
+    PT_STATS_I2C(1, 2 + len, err);
     free(p);
     return err;
 }
 
+/* --------- Error handling / recovery --------- */
+static void pt_touch_recovery_task(void *arg);
+
+/* Account a failed frame read; hands the bus to the recovery task after a few in a row */
+static void pt_touch_note_error(esp_err_t err)
+{
+    bool start = false;
+    portENTER_CRITICAL(&pt_health_mux);
+    pt_health.errors++;
+    if (err == ESP_ERR_TIMEOUT)
+        pt_health.timeouts++;
+    if (++pt_health.consecutive_errors >= PT_TOUCH_ERRORS_BEFORE_RECOVERY && !pt_recovering)
+    {
+        pt_recovering = true;
+        pt_health.recovering = true;
+        start = true;
+    }
+    portEXIT_CRITICAL(&pt_health_mux);
+
+    if (!start)
+        return;
+    ESP_LOGW(TAG, "GT911 not responding (%s), recovering", esp_err_to_name(err));
+    /* Recovery sleeps through the controller reset: never do it on the caller's (LVGL) thread */
+    if (xTaskCreate(pt_touch_recovery_task, "pt_touch_rec", 3072, NULL, 4, NULL) != pdPASS)
+    {
+        portENTER_CRITICAL(&pt_health_mux);
+        pt_recovering = false;
+        pt_health.recovering = false;
+        pt_health.consecutive_errors = 0;
+        portEXIT_CRITICAL(&pt_health_mux);
+    }
+}
+
+static inline void pt_touch_note_ok(void)
+{
+    portENTER_CRITICAL(&pt_health_mux);
+    pt_health.consecutive_errors = 0;
+    portEXIT_CRITICAL(&pt_health_mux);
+}
+
+/* Bring the controller back at its current address: re-probe, reset it if it still does not answer */
+static esp_err_t pt_touch_reinit(void)
+{
+    if (pt_touch_probe_addr(pt_i2c_bus, pt_i2c_addr, PT_TOUCH_I2C_TIMEOUT_MS))
+        return ESP_OK;
+
+    portENTER_CRITICAL(&pt_health_mux);
+    pt_health.reinits++;
+    portEXIT_CRITICAL(&pt_health_mux);
+    pt_touch_addr_select(pt_i2c_addr == 0x5D);
+    vTaskDelay(pdMS_TO_TICKS(80));
+    if (!pt_touch_probe_addr(pt_i2c_bus, pt_i2c_addr, 50))
+        return ESP_ERR_NOT_FOUND;
+    uint8_t st = 0;
+    return pt_touch_i2c_read(PT_GT911_REG_STATUS, &st, 1);
+}
+
+static void pt_touch_recovery_task(void *arg)
+{
+    (void)arg;
+    uint32_t backoff = PT_TOUCH_BACKOFF_MIN_MS;
+    while (true)
+    {
+        portENTER_CRITICAL(&pt_health_mux);
+        pt_health.bus_resets++;
+        pt_health.backoff_ms = backoff;
+        portEXIT_CRITICAL(&pt_health_mux);
+
+        /* Clocks SCL until a slave stuck mid-byte releases SDA, then re-inits the controller */
+        i2c_master_bus_reset(pt_i2c_bus);
+        if (pt_touch_reinit() == ESP_OK)
+            break;
+
+        portENTER_CRITICAL(&pt_health_mux);
+        pt_health.recovery_failures++;
+        portEXIT_CRITICAL(&pt_health_mux);
+        vTaskDelay(pdMS_TO_TICKS(backoff));
+        backoff = (backoff * 2 > CONFIG_PT_TOUCH_RECOVERY_BACKOFF_MAX_MS) ? CONFIG_PT_TOUCH_RECOVERY_BACKOFF_MAX_MS : backoff * 2;
+    }
+
+    /* The address-select reset reconfigures the INT pin */
+    if (pt_int_cb || pt_touch_task_handle)
+        (void)pt_touch_int_arm();
+
+    portENTER_CRITICAL(&pt_health_mux);
+    pt_health.consecutive_errors = 0;
+    pt_health.recovering = false;
+    pt_health.backoff_ms = 0;
+    pt_recovering = false;
+    portEXIT_CRITICAL(&pt_health_mux);
+    ESP_LOGI(TAG, "GT911 recovered @ 0x%02X", pt_i2c_addr);
+
+    /* A frame may have been signalled while reads were suspended */
+    if (pt_touch_task_handle)
+        xTaskNotifyGive(pt_touch_task_handle);
+    vTaskDelete(NULL);
+}
+
+/* --------- GT911 configuration block --------- */
+/* Offsets inside the block that starts at PT_GT911_REG_CONFIG */
+#define PT_GT911_CFG_VERSION 0x00
+#define PT_GT911_CFG_X_MAX 0x01
+#define PT_GT911_CFG_Y_MAX 0x03
+#define PT_GT911_CFG_TOUCH_NUMBER 0x05
+#define PT_GT911_CFG_MODULE_SWITCH1 0x06
+#define PT_GT911_CFG_TOUCH_LEVEL 0x0C
+#define PT_GT911_CFG_LEAVE_LEVEL 0x0D
+#define PT_GT911_CFG_REFRESH_RATE 0x0F
+
+/* Block + checksum + fresh flag, laid out like the registers so it is written in one transaction */
+static uint8_t pt_cfg_raw[PT_GT911_CONFIG_LEN + 2];
+static bool pt_cfg_valid = false;
+
+static uint8_t pt_touch_config_checksum(const uint8_t *block)
+{
+    uint8_t sum = 0;
+    for (size_t i = 0; i < PT_GT911_CONFIG_LEN; ++i)
+        sum += block[i];
+    return (uint8_t)(~sum + 1);
+}
+
+static void pt_touch_config_unpack(const uint8_t *b, pt_touch_gt911_config_t *out)
+{
+    out->version = b[PT_GT911_CFG_VERSION];
+    out->x_max = (uint16_t)(b[PT_GT911_CFG_X_MAX] | (b[PT_GT911_CFG_X_MAX + 1] << 8));
+    out->y_max = (uint16_t)(b[PT_GT911_CFG_Y_MAX] | (b[PT_GT911_CFG_Y_MAX + 1] << 8));
+    out->touch_number = b[PT_GT911_CFG_TOUCH_NUMBER] & 0x0F;
+    out->module_switch1 = b[PT_GT911_CFG_MODULE_SWITCH1];
+    out->touch_level = b[PT_GT911_CFG_TOUCH_LEVEL];
+    out->leave_level = b[PT_GT911_CFG_LEAVE_LEVEL];
+    out->refresh_rate = b[PT_GT911_CFG_REFRESH_RATE] & 0x0F;
+}
+
+esp_err_t pt_touch_config_read(pt_touch_gt911_config_t *out)
+{
+    if (!out)
+        return ESP_ERR_INVALID_ARG;
+    if (!pt_i2c_dev)
+        return ESP_ERR_INVALID_STATE;
+    if (!pt_cfg_valid)
+    {
+        uint8_t raw[PT_GT911_CONFIG_LEN + 1];
+        ESP_RETURN_ON_ERROR(pt_touch_i2c_read(PT_GT911_REG_CONFIG, raw, sizeof(raw)), TAG, "read config");
+        if (pt_touch_config_checksum(raw) != raw[PT_GT911_CONFIG_LEN])
+        {
+            ESP_LOGW(TAG, "GT911 config checksum mismatch (0x%02X, expected 0x%02X)",
+                     raw[PT_GT911_CONFIG_LEN], pt_touch_config_checksum(raw));
+            return ESP_ERR_INVALID_CRC;
+        }
+        memcpy(pt_cfg_raw, raw, sizeof(raw));
+        pt_cfg_raw[PT_GT911_CONFIG_LEN + 1] = 1; // Config_Fresh, only meaningful when written
+        pt_cfg_valid = true;
+    }
+    pt_touch_config_unpack(pt_cfg_raw, out);
+    return ESP_OK;
+}
+
+esp_err_t pt_touch_config_write(const pt_touch_gt911_config_t *cfg)
+{
+    if (!cfg || cfg->touch_number < 1 || cfg->touch_number > PT_GT911_MAX_POINTS || cfg->refresh_rate > 15 ||
+        cfg->x_max == 0 || cfg->y_max == 0)
+        return ESP_ERR_INVALID_ARG;
+    pt_touch_gt911_config_t cur;
+    ESP_RETURN_ON_ERROR(pt_touch_config_read(&cur), TAG, "config");
+
+    uint8_t raw[sizeof(pt_cfg_raw)];
+    memcpy(raw, pt_cfg_raw, sizeof(raw));
+    raw[PT_GT911_CFG_X_MAX] = (uint8_t)cfg->x_max;
+    raw[PT_GT911_CFG_X_MAX + 1] = (uint8_t)(cfg->x_max >> 8);
+    raw[PT_GT911_CFG_Y_MAX] = (uint8_t)cfg->y_max;
+    raw[PT_GT911_CFG_Y_MAX + 1] = (uint8_t)(cfg->y_max >> 8);
+    raw[PT_GT911_CFG_TOUCH_NUMBER] = (raw[PT_GT911_CFG_TOUCH_NUMBER] & 0xF0) | cfg->touch_number;
+    raw[PT_GT911_CFG_MODULE_SWITCH1] = cfg->module_switch1;
+    raw[PT_GT911_CFG_TOUCH_LEVEL] = cfg->touch_level;
+    raw[PT_GT911_CFG_LEAVE_LEVEL] = cfg->leave_level;
+    raw[PT_GT911_CFG_REFRESH_RATE] = (raw[PT_GT911_CFG_REFRESH_RATE] & 0xF0) | cfg->refresh_rate;
+    if (memcmp(raw, pt_cfg_raw, PT_GT911_CONFIG_LEN) == 0)
+        return ESP_OK; // nothing changed: spare the controller a reprogram
+
+    /* Same Config_Version: the GT911 only accepts a block whose version is not older than its own */
+    raw[PT_GT911_CONFIG_LEN] = pt_touch_config_checksum(raw);
+    raw[PT_GT911_CONFIG_LEN + 1] = 1;
+    ESP_RETURN_ON_ERROR(pt_touch_i2c_write(PT_GT911_REG_CONFIG, raw, sizeof(raw)), TAG, "write config");
+    memcpy(pt_cfg_raw, raw, sizeof(raw));
+    ESP_LOGI(TAG, "GT911 config written: %ux%u, %u pts, report %u ms, levels %u/%u",
+             cfg->x_max, cfg->y_max, cfg->touch_number, 5 + cfg->refresh_rate, cfg->touch_level, cfg->leave_level);
+    vTaskDelay(pdMS_TO_TICKS(100)); // the controller reloads its configuration
+    return ESP_OK;
+}
+
+#ifdef CONFIG_PT_TOUCH_GT911_TUNE
+static void pt_touch_apply_tuning(void)
+{
+    pt_touch_gt911_config_t cfg;
+    esp_err_t err = pt_touch_config_read(&cfg);
+    if (err != ESP_OK)
+    {
+        ESP_LOGW(TAG, "GT911 config not tuned: %s", esp_err_to_name(err));
+        return;
+    }
+    cfg.refresh_rate = CONFIG_PT_TOUCH_GT911_REFRESH_RATE;
+#ifdef CONFIG_PT_TOUCH_GT911_MATCH_RESOLUTION
+    cfg.x_max = PT_GT911_MAX_X;
+    cfg.y_max = PT_GT911_MAX_Y;
+#endif
+#if CONFIG_PT_TOUCH_GT911_TOUCH_LEVEL > 0
+    cfg.touch_level = CONFIG_PT_TOUCH_GT911_TOUCH_LEVEL;
+#endif
+#if CONFIG_PT_TOUCH_GT911_LEAVE_LEVEL > 0
+    cfg.leave_level = CONFIG_PT_TOUCH_GT911_LEAVE_LEVEL;
+#endif
+    err = pt_touch_config_write(&cfg);
+    if (err != ESP_OK)
+        ESP_LOGW(TAG, "GT911 config write failed: %s", esp_err_to_name(err));
+}
+#endif
+
 /* --------- Public API --------- */
 esp_err_t pt_touch_begin(void)
 {
@@ -109,6 +465,9 @@ esp_err_t pt_touch_begin(void)
         .flags = {.enable_internal_pullup = true},
     };
     ESP_RETURN_ON_ERROR(i2c_new_master_bus(&bus_cfg, &pt_i2c_bus), TAG, "new bus");
+#ifdef CONFIG_PT_TOUCH_STATS
+    pt_stats_start_us = esp_timer_get_time();
+#endif
 
     // 2) Probe without reset
     uint8_t addr = 0;
@@ -153,11 +512,17 @@ esp_err_t pt_touch_begin(void)
         .scl_speed_hz = 400000,
     };
     ESP_RETURN_ON_ERROR(i2c_master_bus_add_device(pt_i2c_bus, &dev_cfg, &pt_i2c_dev), TAG, "add dev");
+    pt_i2c_addr = addr;
 
     // 5) Prime read
     uint8_t st = 0;
     ESP_RETURN_ON_ERROR(pt_touch_i2c_read(PT_GT911_REG_STATUS, &st, 1), TAG, "prime STATUS");
     ESP_LOGI(TAG, "STATUS=0x%02X", st);
+
+    // 6) Report rate / output range
+#ifdef CONFIG_PT_TOUCH_GT911_TUNE
+    pt_touch_apply_tuning();
+#endif
     ESP_LOGI(TAG, "PT_GT911 ready @ 0x%02X", addr);
     return ESP_OK;
 }
@@ -165,50 +530,289 @@ esp_err_t pt_touch_begin(void)
 bool pt_touch_i2c_ready(void)
 {
     uint8_t st = 0;
-    if (pt_i2c_dev && pt_touch_i2c_read(PT_GT911_REG_STATUS, &st, 1) == ESP_OK)
+    if (pt_i2c_dev && !pt_recovering && pt_touch_i2c_read(PT_GT911_REG_STATUS, &st, 1) == ESP_OK)
         return (st & 0x80) != 0;
     return false;
 }
 
-bool pt_touch_get_touch(pt_touch_event_t *ev)
+/* Read one frame: STATUS and the first `burst_points` points in a single transaction,
+   the remaining points (if any) in a second one, then acknowledge. */
+static bool pt_touch_read_frame(pt_touch_event_t *ev, uint8_t burst_points)
 {
-    if (!ev)
-        return false;
     ev->number = 0;
+    if (pt_recovering)
+        return false;
 
-    uint8_t status = 0;
-    if (pt_touch_i2c_read(PT_GT911_REG_STATUS, &status, 1) != ESP_OK)
+    uint8_t buf[1 + PT_GT911_MAX_POINTS * 8];
+    esp_err_t err = pt_touch_i2c_read(PT_GT911_REG_STATUS, buf, 1 + burst_points * 8);
+    if (err != ESP_OK)
+    {
+        pt_touch_note_error(err);
         return false;
+    }
+    pt_touch_note_ok();
+    const uint8_t status = buf[0];
     if (!(status & 0x80))
         return false; // no new data
 
+    uint8_t zero = 0;
     uint8_t n = status & 0x0F;
-    if (n == 0 || n > PT_GT911_MAX_POINTS)
+    if (n > PT_GT911_MAX_POINTS)
     {
-        uint8_t zero = 0;
         (void)pt_touch_i2c_write(PT_GT911_REG_STATUS, &zero, 1);
         return false;
     }
-
-    uint8_t buf[PT_GT911_MAX_POINTS * 8];
-    if (pt_touch_i2c_read(PT_GT911_REG_POINT1, buf, n * 8) != ESP_OK)
-        return false;
+    if (n > burst_points)
+    {
+        err = pt_touch_i2c_read(PT_GT911_REG_POINT1 + burst_points * 8, &buf[1 + burst_points * 8], (n - burst_points) * 8);
+        if (err != ESP_OK)
+        {
+            pt_touch_note_error(err);
+            return false;
+        }
+    }
 
     for (uint8_t i = 0; i < n; ++i)
     {
-        const uint8_t *p = &buf[i * 8];
+        const uint8_t *p = &buf[1 + i * 8];
         ev->point[i].track_id = p[0];
         ev->point[i].x = ((uint16_t)p[2] << 8) | p[1];
         ev->point[i].y = ((uint16_t)p[4] << 8) | p[3];
         ev->point[i].size = ((uint16_t)p[6] << 8) | p[5];
         if (ev->point[i].x >= PT_GT911_MAX_X)
             ev->point[i].x = PT_GT911_MAX_X - 1;
-        if (ev->point[i].y >= PT_GT911_MAX_X)
+        if (ev->point[i].y >= PT_GT911_MAX_Y)
             ev->point[i].y = PT_GT911_MAX_Y - 1;
     }
-    ev->number = n;
+    ev->number = n; // a fresh frame with no points means every finger lifted
 
-    uint8_t zero = 0;
     (void)pt_touch_i2c_write(PT_GT911_REG_STATUS, &zero, 1);
     return true;
 }
+
+bool pt_touch_get_touch(pt_touch_event_t *ev)
+{
+    if (!ev)
+        return false;
+    /* Polling sees mostly empty frames: keep the burst short (STATUS + first point) */
+    const int64_t t0 = PT_STATS_NOW();
+    const bool fresh = pt_touch_read_frame(ev, 1);
+    const int64_t t1 = esp_timer_get_time();
+#ifdef CONFIG_PT_TOUCH_STATS
+    pt_stats_frame(fresh, t0, t1);
+#else
+    (void)t0;
+#endif
+    if (!fresh)
+        return false;
+    ev->timestamp_us = t1;
+    return true;
+}
+
+esp_err_t pt_touch_set_int_cb(pt_touch_int_cb_t cb, void *arg)
+{
+    pt_int_cb_arg = arg;
+    pt_int_cb = cb;
+    if (!cb)
+    {
+#if (PT_GT911_INT_GPIO >= 0)
+        gpio_isr_handler_remove(PT_GT911_INT_GPIO);
+#endif
+        return ESP_OK;
+    }
+    return pt_touch_int_arm();
+}
+
+/* --------- INT-driven sampling task --------- */
+static void pt_touch_ring_push(const pt_touch_event_t *ev)
+{
+    portENTER_CRITICAL(&pt_ring_mux);
+    const bool full = (pt_ring_head - pt_ring_tail == CONFIG_PT_TOUCH_EVENT_QUEUE_LEN);
+    if (full)
+        pt_ring_tail++; // the newest frame matters more than the oldest
+    pt_ring[pt_ring_head % CONFIG_PT_TOUCH_EVENT_QUEUE_LEN] = *ev;
+    pt_ring_head++;
+    portEXIT_CRITICAL(&pt_ring_mux);
+#ifdef CONFIG_PT_TOUCH_STATS
+    if (full)
+    {
+        portENTER_CRITICAL(&pt_stats_mux);
+        pt_stats.events_dropped++;
+        portEXIT_CRITICAL(&pt_stats_mux);
+    }
+#else
+    (void)full;
+#endif
+}
+
+static void pt_touch_task(void *arg)
+{
+    (void)arg;
+    ESP_LOGI(TAG, "touch sampling task started");
+    while (true)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        pt_touch_event_t ev;
+        /* The task only wakes on INT, so data is almost always there: read every point at once */
+        const int64_t t0 = PT_STATS_NOW();
+        const bool fresh = pt_touch_read_frame(&ev, PT_GT911_MAX_POINTS);
+        const int64_t t1 = esp_timer_get_time();
+
+        portENTER_CRITICAL(&pt_ring_mux);
+        const int64_t edge = pt_int_edge_us;
+        pt_int_edge_us = 0;
+        portEXIT_CRITICAL(&pt_ring_mux);
+#ifdef CONFIG_PT_TOUCH_STATS
+        pt_stats_frame(fresh, t0, t1);
+        if (fresh && edge)
+        {
+            portENTER_CRITICAL(&pt_stats_mux);
+            pt_stats_lat_add(&pt_stats.int_to_read, t1 - edge);
+            portEXIT_CRITICAL(&pt_stats_mux);
+        }
+#else
+        (void)t0;
+#endif
+        if (!fresh)
+            continue; // second edge of the INT pulse, or an I2C error
+
+        ev.timestamp_us = edge ? edge : t1;
+        pt_touch_ring_push(&ev);
+        if (pt_event_cb)
+            pt_event_cb(pt_event_cb_arg);
+    }
+}
+
+esp_err_t pt_touch_start_task(pt_touch_event_cb_t cb, void *arg)
+{
+    if (!pt_i2c_dev)
+        return ESP_ERR_INVALID_STATE;
+    pt_event_cb_arg = arg;
+    pt_event_cb = cb;
+    if (pt_touch_task_handle)
+        return ESP_OK;
+
+    if (!pt_ring)
+    {
+        pt_ring = heap_caps_calloc(CONFIG_PT_TOUCH_EVENT_QUEUE_LEN, sizeof(pt_touch_event_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (!pt_ring)
+            return ESP_ERR_NO_MEM;
+    }
+    /* Core 0: keep the I2C traffic off the LVGL core */
+    if (xTaskCreatePinnedToCore(pt_touch_task, "pt_touch", 3072, NULL, 6, &pt_touch_task_handle, 0) != pdPASS)
+        return ESP_ERR_NO_MEM;
+
+    esp_err_t err = pt_touch_int_arm();
+    if (err != ESP_OK)
+    {
+        vTaskDelete(pt_touch_task_handle);
+        pt_touch_task_handle = NULL;
+        return err;
+    }
+    /* A frame may already be pending (its INT pulse came before the ISR was armed) */
+    xTaskNotifyGive(pt_touch_task_handle);
+    return ESP_OK;
+}
+
+bool pt_touch_pop_event(pt_touch_event_t *ev)
+{
+    if (!ev || !pt_ring)
+        return false;
+    bool ok = false;
+    portENTER_CRITICAL(&pt_ring_mux);
+    if (pt_ring_head != pt_ring_tail)
+    {
+        *ev = pt_ring[pt_ring_tail % CONFIG_PT_TOUCH_EVENT_QUEUE_LEN];
+        pt_ring_tail++;
+        ok = true;
+    }
+    portEXIT_CRITICAL(&pt_ring_mux);
+    return ok;
+}
+
+size_t pt_touch_pending_events(void)
+{
+    portENTER_CRITICAL(&pt_ring_mux);
+    const size_t n = pt_ring_head - pt_ring_tail;
+    portEXIT_CRITICAL(&pt_ring_mux);
+    return n;
+}
+
+/* --------- Statistics --------- */
+void pt_touch_stats_note_read(const pt_touch_event_t *ev)
+{
+#ifdef CONFIG_PT_TOUCH_STATS
+    const int64_t now = esp_timer_get_time();
+    pt_stats_lvgl_task = xTaskGetCurrentTaskHandle();
+    portENTER_CRITICAL(&pt_stats_mux);
+    pt_stats.lvgl_reads++;
+    if (ev)
+    {
+        pt_stats.lvgl_delivered++;
+        pt_stats_lat_add(&pt_stats.int_to_deliver, now - ev->timestamp_us);
+    }
+    portEXIT_CRITICAL(&pt_stats_mux);
+#else
+    (void)ev;
+#endif
+}
+
+uint32_t pt_touch_latency_percentile_us(const pt_touch_latency_t *lat, uint32_t pct)
+{
+    if (!lat || lat->count == 0)
+        return 0;
+    const uint32_t target = (uint32_t)(((uint64_t)lat->count * pct + 99) / 100);
+    uint32_t acc = 0;
+    for (uint32_t i = 0; i < PT_TOUCH_LAT_BUCKETS - 1; ++i)
+    {
+        acc += lat->hist[i];
+        if (acc >= target)
+        {
+            const uint32_t upper = i ? (1u << i) - 1 : 0;
+            return upper < lat->max_us ? upper : lat->max_us;
+        }
+    }
+    return lat->max_us;
+}
+
+esp_err_t pt_touch_get_stats(pt_touch_stats_t *out, bool reset)
+{
+#ifdef CONFIG_PT_TOUCH_STATS
+    if (!out)
+        return ESP_ERR_INVALID_ARG;
+    const int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&pt_stats_mux);
+    *out = pt_stats;
+    const int64_t start = pt_stats_start_us;
+    if (reset)
+    {
+        memset(&pt_stats, 0, sizeof(pt_stats));
+        pt_stats_start_us = now;
+    }
+    portEXIT_CRITICAL(&pt_stats_mux);
+
+    const uint64_t window_us = (uint64_t)(now - start);
+    out->window_ms = (uint32_t)(window_us / 1000);
+    if (window_us)
+    {
+        out->i2c_transactions_per_s = (uint32_t)((uint64_t)out->i2c_transactions * 1000000 / window_us);
+        out->i2c_bytes_per_s = (uint32_t)(out->i2c_bytes * 1000000 / window_us);
+    }
+    return ESP_OK;
+#else
+    (void)out;
+    (void)reset;
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+/* --------- Health --------- */
+void pt_touch_get_health(pt_touch_health_t *out)
+{
+    if (!out)
+        return;
+    portENTER_CRITICAL(&pt_health_mux);
+    *out = pt_health;
+    portEXIT_CRITICAL(&pt_health_mux);
+}
@@ -0,0 +1,613 @@
+#include "pandatouch_touch_replay.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#ifdef ESP_PLATFORM
+#include <errno.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "sdkconfig.h"
+#include "pandatouch_msc.h"
+#else
+/* Host build (I2C driver stubbed): replay only, on plain libc */
+#include <time.h>
+#include <pthread.h>
+#define CONFIG_PT_TOUCH_REPLAY 1
+#ifndef CONFIG_PT_TOUCH_REPLAY_MAX_KB
+#define CONFIG_PT_TOUCH_REPLAY_MAX_KB 4096
+#endif
+#define ESP_LOGI(tag, fmt, ...) printf("I %s: " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) printf("W %s: " fmt "\n", tag, ##__VA_ARGS__)
+#endif
+
+#ifdef CONFIG_PT_TOUCH_REPLAY
+
+/* --------- Logging --------- */
+static const char *TAG = "PandaTouch::TouchReplay";
+
+/* --------- Trace format --------- */
+#define PT_TRACE_HDR_LEN 8
+#define PT_TRACE_FRAME_HDR_LEN 5
+#define PT_TRACE_POINT_LEN 7
+#define PT_TRACE_FRAME_MAX (PT_TRACE_FRAME_HDR_LEN + PT_GT911_MAX_POINTS * PT_TRACE_POINT_LEN)
+
+static inline uint16_t pt_rd16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static inline uint32_t pt_rd32(const uint8_t *p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+static inline void pt_wr16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+static inline void pt_wr32(uint8_t *p, uint32_t v)
+{
+    pt_wr16(p, (uint16_t)v);
+    pt_wr16(p + 2, (uint16_t)(v >> 16));
+}
+
+/* Validate a trace once so replay never bounds-checks mid-stream. A trailing partial frame
+   (file cut short) is dropped by shrinking *len. Returns the frame count, or -1 if invalid. */
+static int32_t pt_trace_scan(const uint8_t *d, size_t *len)
+{
+    if (*len < PT_TRACE_HDR_LEN || memcmp(d, PT_TOUCH_TRACE_MAGIC, 4) != 0 || d[4] != PT_TOUCH_TRACE_VERSION)
+        return -1;
+    size_t pos = PT_TRACE_HDR_LEN;
+    int32_t frames = 0;
+    while (*len - pos >= PT_TRACE_FRAME_HDR_LEN)
+    {
+        const uint8_t count = d[pos + 4];
+        if (count > PT_GT911_MAX_POINTS)
+            return -1;
+        const size_t flen = PT_TRACE_FRAME_HDR_LEN + (size_t)count * PT_TRACE_POINT_LEN;
+        if (*len - pos < flen)
+            break;
+        pos += flen;
+        frames++;
+    }
+    *len = pos;
+    return frames;
+}
+
+/* --------- Platform --------- */
+#ifdef ESP_PLATFORM
+static portMUX_TYPE pt_rp_mux = portMUX_INITIALIZER_UNLOCKED;
+#define PT_RP_LOCK() portENTER_CRITICAL(&pt_rp_mux)
+#define PT_RP_UNLOCK() portEXIT_CRITICAL(&pt_rp_mux)
+#define PT_RP_NOW_US() esp_timer_get_time()
+#else
+static pthread_mutex_t pt_rp_mtx = PTHREAD_MUTEX_INITIALIZER;
+#define PT_RP_LOCK() pthread_mutex_lock(&pt_rp_mtx)
+#define PT_RP_UNLOCK() pthread_mutex_unlock(&pt_rp_mtx)
+static int64_t pt_rp_now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+#define PT_RP_NOW_US() pt_rp_now_us()
+#endif
+
+/* --------- Replay state --------- */
+static const uint8_t *pt_rp_data = NULL;
+static size_t pt_rp_len = 0;
+static size_t pt_rp_pos = 0;      /* next frame */
+static bool pt_rp_owned = false;  /* data was loaded by pt_touch_replay_start() */
+static volatile bool pt_rp_active = false;
+static bool pt_rp_down = false;   /* last delivered frame had points */
+static pt_touch_replay_mode_t pt_rp_mode = PT_TOUCH_REPLAY_REALTIME;
+static int64_t pt_rp_due_us = 0;  /* due time of the frame at pt_rp_pos */
+static uint32_t pt_rp_frames = 0;
+static uint32_t pt_rp_replayed = 0;
+static uint32_t pt_rp_max_lag_us = 0;
+static pt_touch_event_cb_t pt_rp_notify = NULL;
+static void *pt_rp_notify_arg = NULL;
+#ifdef ESP_PLATFORM
+static esp_timer_handle_t pt_rp_timer = NULL;
+
+static void pt_rp_timer_cb(void *arg)
+{
+    (void)arg;
+    if (pt_rp_notify)
+        pt_rp_notify(pt_rp_notify_arg);
+}
+#endif
+
+/* Ask for an input device read once the next frame is due */
+static void pt_rp_kick(int64_t wait_us)
+{
+    if (wait_us <= 0)
+    {
+        if (pt_rp_notify)
+            pt_rp_notify(pt_rp_notify_arg);
+        return;
+    }
+#ifdef ESP_PLATFORM
+    if (pt_rp_timer)
+    {
+        esp_timer_stop(pt_rp_timer);
+        esp_timer_start_once(pt_rp_timer, (uint64_t)wait_us);
+    }
+#endif
+    /* Host builds poll the input device from their LVGL loop */
+}
+
+static void pt_rp_decode(const uint8_t *f, pt_touch_event_t *ev)
+{
+    memset(ev, 0, sizeof(*ev));
+    ev->number = f[4];
+    const uint8_t *p = f + PT_TRACE_FRAME_HDR_LEN;
+    for (uint8_t i = 0; i < ev->number; i++, p += PT_TRACE_POINT_LEN)
+    {
+        ev->point[i].track_id = p[0];
+        ev->point[i].x = pt_rd16(p + 1);
+        ev->point[i].y = pt_rd16(p + 3);
+        ev->point[i].size = pt_rd16(p + 5);
+    }
+}
+
+static esp_err_t pt_rp_begin(const uint8_t *data, size_t len, pt_touch_replay_mode_t mode, bool owned)
+{
+    const int32_t frames = pt_trace_scan(data, &len);
+    if (frames < 0)
+    {
+        ESP_LOGW(TAG, "not a PTTR v%d trace", PT_TOUCH_TRACE_VERSION);
+        if (owned)
+            free((void *)data);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    pt_touch_replay_stop();
+#ifdef ESP_PLATFORM
+    if (!pt_rp_timer)
+    {
+        const esp_timer_create_args_t args = {
+            .callback = pt_rp_timer_cb,
+            .name = "pt_replay",
+        };
+        if (esp_timer_create(&args, &pt_rp_timer) != ESP_OK)
+            pt_rp_timer = NULL; /* still works with polling input devices */
+    }
+#endif
+
+    PT_RP_LOCK();
+    pt_rp_data = data;
+    pt_rp_len = len;
+    pt_rp_pos = PT_TRACE_HDR_LEN;
+    pt_rp_owned = owned;
+    pt_rp_down = false;
+    pt_rp_mode = mode;
+    pt_rp_due_us = PT_RP_NOW_US() + (frames ? pt_rd32(data + PT_TRACE_HDR_LEN) : 0);
+    pt_rp_frames = (uint32_t)frames;
+    pt_rp_replayed = 0;
+    pt_rp_max_lag_us = 0;
+    pt_rp_active = true;
+    PT_RP_UNLOCK();
+
+    ESP_LOGI(TAG, "replaying %ld frames (%s)", (long)frames, mode == PT_TOUCH_REPLAY_FAST ? "fast" : "realtime");
+    pt_rp_kick(0);
+    return ESP_OK;
+}
+
+esp_err_t pt_touch_replay_start_mem(const void *data, size_t len, pt_touch_replay_mode_t mode)
+{
+    if (!data)
+        return ESP_ERR_INVALID_ARG;
+    return pt_rp_begin((const uint8_t *)data, len, mode, false);
+}
+
+esp_err_t pt_touch_replay_start(const char *path, pt_touch_replay_mode_t mode)
+{
+    if (!path)
+        return ESP_ERR_INVALID_ARG;
+    const size_t max = (size_t)CONFIG_PT_TOUCH_REPLAY_MAX_KB * 1024;
+    size_t len = 0;
+
+#ifdef ESP_PLATFORM
+    uint8_t *buf = heap_caps_malloc(max, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!buf)
+        return ESP_ERR_NO_MEM;
+    const int rc = pt_usb_read(path, buf, max, &len);
+    if (rc != 0)
+    {
+        free(buf);
+        ESP_LOGW(TAG, "%s: read failed (%d)", path, rc);
+        return rc == -ENODEV ? ESP_ERR_INVALID_STATE : ESP_ERR_NOT_FOUND;
+    }
+#else
+    FILE *f = fopen(path, "rb");
+    if (!f)
+        return ESP_ERR_NOT_FOUND;
+    uint8_t *buf = malloc(max);
+    if (!buf)
+    {
+        fclose(f);
+        return ESP_ERR_NO_MEM;
+    }
+    len = fread(buf, 1, max, f);
+    fclose(f);
+#endif
+
+    if (len == max)
+        ESP_LOGW(TAG, "%s: trace larger than PT_TOUCH_REPLAY_MAX_KB, replaying the first %u bytes", path, (unsigned)max);
+    uint8_t *fit = realloc(buf, len ? len : 1);
+    return pt_rp_begin(fit ? fit : buf, len, mode, true);
+}
+
+void pt_touch_replay_stop(void)
+{
+    PT_RP_LOCK();
+    const uint8_t *data = pt_rp_owned ? pt_rp_data : NULL;
+    pt_rp_active = false;
+    pt_rp_data = NULL;
+    pt_rp_owned = false;
+    PT_RP_UNLOCK();
+#ifdef ESP_PLATFORM
+    if (pt_rp_timer)
+        esp_timer_stop(pt_rp_timer);
+#endif
+    free((void *)data);
+}
+
+bool pt_touch_replay_active(void)
+{
+    return pt_rp_active;
+}
+
+bool pt_touch_replay_next(pt_touch_event_t *ev, bool *more)
+{
+    if (more)
+        *more = false;
+    if (!pt_rp_active || !ev)
+        return false;
+
+    const int64_t now = PT_RP_NOW_US();
+    bool got = false;
+    bool ended = false;
+    int64_t wait_us = -1; /* until the next frame is due (-1: nothing left) */
+
+    PT_RP_LOCK();
+    if (!pt_rp_active)
+    {
+        PT_RP_UNLOCK(); // stopped concurrently
+        return false;
+    }
+    if (pt_rp_pos >= pt_rp_len)
+    {
+        // End of trace: lift a finger the recording left down so LVGL does not see a stuck press
+        if (pt_rp_down)
+        {
+            memset(ev, 0, sizeof(*ev));
+            ev->timestamp_us = now;
+            pt_rp_down = false;
+            got = true;
+        }
+        ended = true;
+    }
+    else
+    {
+        const uint8_t *f = pt_rp_data + pt_rp_pos;
+        if (pt_rp_mode == PT_TOUCH_REPLAY_FAST || now >= pt_rp_due_us)
+        {
+            if (pt_rp_mode == PT_TOUCH_REPLAY_REALTIME)
+            {
+                const int64_t lag = now - pt_rp_due_us;
+                if (lag > pt_rp_max_lag_us)
+                    pt_rp_max_lag_us = lag > UINT32_MAX ? UINT32_MAX : (uint32_t)lag;
+            }
+            pt_rp_decode(f, ev);
+            ev->timestamp_us = pt_rp_mode == PT_TOUCH_REPLAY_REALTIME ? pt_rp_due_us : now;
+            pt_rp_down = ev->number > 0;
+            pt_rp_pos += PT_TRACE_FRAME_HDR_LEN + (size_t)f[4] * PT_TRACE_POINT_LEN;
+            pt_rp_replayed++;
+            got = true;
+            if (pt_rp_pos < pt_rp_len)
+                pt_rp_due_us += pt_rd32(pt_rp_data + pt_rp_pos);
+        }
+        // Fast mode delivers one frame per read; the end of the trace is handled right away
+        wait_us = (pt_rp_mode == PT_TOUCH_REPLAY_FAST || pt_rp_pos >= pt_rp_len) ? 0 : pt_rp_due_us - now;
+    }
+    PT_RP_UNLOCK();
+
+    if (ended)
+    {
+        ESP_LOGI(TAG, "replay done: %lu frames, max lag %lu us", (unsigned long)pt_rp_replayed, (unsigned long)pt_rp_max_lag_us);
+        pt_touch_replay_stop();
+        return got;
+    }
+    if (wait_us < 0)
+        return got;
+    // Realtime frames already due are consumed in the same read pass
+    if (got && wait_us <= 0 && pt_rp_mode == PT_TOUCH_REPLAY_REALTIME && more)
+        *more = true;
+    else
+        pt_rp_kick(wait_us);
+    return got;
+}
+
+void pt_touch_replay_set_notify(pt_touch_event_cb_t cb, void *arg)
+{
+    PT_RP_LOCK();
+    pt_rp_notify = cb;
+    pt_rp_notify_arg = arg;
+    PT_RP_UNLOCK();
+}
+
+/* --------- Recorder --------- */
+#ifdef ESP_PLATFORM
+#define PT_REC_BUF_BYTES CONFIG_PT_TOUCH_RECORD_BUF_BYTES
+
+/* Two buffers: the LVGL task fills one while the recorder task writes the other to USB */
+static char pt_rec_path[128];
+static uint8_t *pt_rec_buf[2] = {NULL, NULL};
+static size_t pt_rec_len[2] = {0, 0};
+static uint8_t pt_rec_cur = 0;            /* buffer being filled */
+static volatile bool pt_rec_flushing = false; /* the other buffer is being written */
+static volatile bool pt_rec_quit = false;
+static bool pt_rec_active = false;
+static int64_t pt_rec_last_us = 0;        /* timestamp of the previous recorded frame (0: none) */
+static int pt_rec_err = 0;                /* first pt_usb_write() error */
+static uint32_t pt_rec_frames = 0;
+static uint32_t pt_rec_dropped = 0;
+static TaskHandle_t pt_rec_task_handle = NULL;
+static uint32_t pt_rec_kicking = 0;       /* pt_touch_record_frame() calls about to notify the task */
+static SemaphoreHandle_t pt_rec_done = NULL;
+static portMUX_TYPE pt_rec_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static void pt_rec_write(const uint8_t *buf, size_t len)
+{
+    if (!len || pt_rec_err)
+        return;
+    const int rc = pt_usb_write(pt_rec_path, buf, len, true);
+    if (rc != 0)
+    {
+        pt_rec_err = rc;
+        ESP_LOGW(TAG, "%s: write failed (%d), recording continues in memory only", pt_rec_path, rc);
+    }
+}
+
+static void pt_rec_task(void *arg)
+{
+    (void)arg;
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (pt_rec_flushing)
+        {
+            // pt_rec_cur only changes while nothing is being flushed
+            const uint8_t idx = pt_rec_cur ^ 1;
+            pt_rec_write(pt_rec_buf[idx], pt_rec_len[idx]);
+            pt_rec_len[idx] = 0;
+            portENTER_CRITICAL(&pt_rec_mux);
+            pt_rec_flushing = false;
+            portEXIT_CRITICAL(&pt_rec_mux);
+        }
+        if (pt_rec_quit)
+        {
+            // Recording is already inactive: nothing appends to the current buffer any more
+            pt_rec_write(pt_rec_buf[pt_rec_cur], pt_rec_len[pt_rec_cur]);
+            xSemaphoreGive(pt_rec_done);
+            vTaskDelete(NULL);
+        }
+    }
+}
+
+esp_err_t pt_touch_record_start(const char *path)
+{
+    if (!path || path[0] != '/' || strlen(path) >= sizeof(pt_rec_path))
+        return ESP_ERR_INVALID_ARG;
+    if (pt_rec_task_handle || !pt_usb_is_mounted())
+        return ESP_ERR_INVALID_STATE;
+
+    uint8_t hdr[PT_TRACE_HDR_LEN] = {'P', 'T', 'T', 'R', PT_TOUCH_TRACE_VERSION, PT_GT911_MAX_POINTS, 0, 0};
+    const int rc = pt_usb_write(path, hdr, sizeof(hdr), false);
+    if (rc != 0)
+    {
+        ESP_LOGW(TAG, "%s: cannot create trace (%d)", path, rc);
+        return ESP_FAIL;
+    }
+
+    pt_rec_buf[0] = heap_caps_malloc(PT_REC_BUF_BYTES, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    pt_rec_buf[1] = heap_caps_malloc(PT_REC_BUF_BYTES, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    pt_rec_done = xSemaphoreCreateBinary();
+    if (!pt_rec_buf[0] || !pt_rec_buf[1] || !pt_rec_done)
+        goto fail;
+
+    strcpy(pt_rec_path, path);
+    pt_rec_len[0] = pt_rec_len[1] = 0;
+    pt_rec_cur = 0;
+    pt_rec_flushing = false;
+    pt_rec_quit = false;
+    pt_rec_last_us = 0;
+    pt_rec_err = 0;
+    pt_rec_frames = 0;
+    pt_rec_dropped = 0;
+    if (xTaskCreatePinnedToCore(pt_rec_task, "pt_trec", 3072, NULL, 2, &pt_rec_task_handle, 0) != pdPASS)
+    {
+        pt_rec_task_handle = NULL;
+        goto fail;
+    }
+
+    portENTER_CRITICAL(&pt_rec_mux);
+    pt_rec_active = true;
+    portEXIT_CRITICAL(&pt_rec_mux);
+    ESP_LOGI(TAG, "recording touch frames to %s", path);
+    return ESP_OK;
+
+fail:
+    free(pt_rec_buf[0]);
+    free(pt_rec_buf[1]);
+    pt_rec_buf[0] = pt_rec_buf[1] = NULL;
+    if (pt_rec_done)
+        vSemaphoreDelete(pt_rec_done);
+    pt_rec_done = NULL;
+    return ESP_ERR_NO_MEM;
+}
+
+void pt_touch_record_frame(const pt_touch_event_t *ev)
+{
+    if (!pt_rec_active || !ev)
+        return;
+
+    uint8_t rec[PT_TRACE_FRAME_MAX];
+    const uint8_t n = ev->number > PT_GT911_MAX_POINTS ? PT_GT911_MAX_POINTS : ev->number;
+    const int64_t dt = pt_rec_last_us ? ev->timestamp_us - pt_rec_last_us : 0;
+    pt_wr32(rec, dt < 0 ? 0 : (dt > UINT32_MAX ? UINT32_MAX : (uint32_t)dt));
+    rec[4] = n;
+    uint8_t *p = rec + PT_TRACE_FRAME_HDR_LEN;
+    for (uint8_t i = 0; i < n; i++, p += PT_TRACE_POINT_LEN)
+    {
+        p[0] = ev->point[i].track_id;
+        pt_wr16(p + 1, ev->point[i].x);
+        pt_wr16(p + 3, ev->point[i].y);
+        pt_wr16(p + 5, ev->point[i].size);
+    }
+    const size_t rlen = (size_t)(p - rec);
+
+    TaskHandle_t kick = NULL;
+    portENTER_CRITICAL(&pt_rec_mux);
+    if (pt_rec_active)
+    {
+        if (pt_rec_len[pt_rec_cur] + rlen > PT_REC_BUF_BYTES && !pt_rec_flushing)
+        {
+            pt_rec_cur ^= 1;
+            pt_rec_flushing = true;
+            // pt_touch_record_stop() waits for pt_rec_kicking to drop before the task can exit
+            kick = pt_rec_task_handle;
+            pt_rec_kicking++;
+        }
+        if (pt_rec_len[pt_rec_cur] + rlen <= PT_REC_BUF_BYTES)
+        {
+            memcpy(pt_rec_buf[pt_rec_cur] + pt_rec_len[pt_rec_cur], rec, rlen);
+            pt_rec_len[pt_rec_cur] += rlen;
+            pt_rec_last_us = ev->timestamp_us;
+            pt_rec_frames++;
+        }
+        else
+        {
+            // Both buffers busy: the gap shows up as a longer delta on the next frame
+            pt_rec_dropped++;
+        }
+    }
+    portEXIT_CRITICAL(&pt_rec_mux);
+    if (kick)
+    {
+        xTaskNotifyGive(kick);
+        portENTER_CRITICAL(&pt_rec_mux);
+        pt_rec_kicking--;
+        portEXIT_CRITICAL(&pt_rec_mux);
+    }
+}
+
+esp_err_t pt_touch_record_stop(void)
+{
+    portENTER_CRITICAL(&pt_rec_mux);
+    TaskHandle_t task = pt_rec_task_handle;
+    pt_rec_active = false;
+    portEXIT_CRITICAL(&pt_rec_mux);
+    if (!task)
+        return ESP_ERR_INVALID_STATE;
+
+    // No new notifications once inactive; let the ones already started reach the task
+    for (;;)
+    {
+        portENTER_CRITICAL(&pt_rec_mux);
+        const uint32_t kicking = pt_rec_kicking;
+        portEXIT_CRITICAL(&pt_rec_mux);
+        if (!kicking)
+            break;
+        vTaskDelay(1);
+    }
+    pt_rec_quit = true;
+    xTaskNotifyGive(task);
+    if (xSemaphoreTake(pt_rec_done, pdMS_TO_TICKS(5000)) != pdTRUE)
+    {
+        ESP_LOGW(TAG, "%s: recorder did not finish writing", pt_rec_path);
+        return ESP_ERR_TIMEOUT;
+    }
+    portENTER_CRITICAL(&pt_rec_mux);
+    pt_rec_task_handle = NULL;
+    portEXIT_CRITICAL(&pt_rec_mux);
+    vSemaphoreDelete(pt_rec_done);
+    pt_rec_done = NULL;
+    free(pt_rec_buf[0]);
+    free(pt_rec_buf[1]);
+    pt_rec_buf[0] = pt_rec_buf[1] = NULL;
+
+    ESP_LOGI(TAG, "recorded %lu frames to %s (%lu dropped)", (unsigned long)pt_rec_frames, pt_rec_path, (unsigned long)pt_rec_dropped);
+    return pt_rec_err ? ESP_FAIL : ESP_OK;
+}
+#else
+esp_err_t pt_touch_record_start(const char *path)
+{
+    (void)path;
+    return ESP_ERR_NOT_SUPPORTED;
+}
+esp_err_t pt_touch_record_stop(void) { return ESP_ERR_NOT_SUPPORTED; }
+void pt_touch_record_frame(const pt_touch_event_t *ev) { (void)ev; }
+#endif
+
+void pt_touch_replay_get_status(pt_touch_replay_status_t *out)
+{
+    if (!out)
+        return;
+    memset(out, 0, sizeof(*out));
+#ifdef ESP_PLATFORM
+    out->recording = pt_rec_active;
+    out->frames_recorded = pt_rec_frames;
+    out->frames_dropped = pt_rec_dropped;
+#endif
+    PT_RP_LOCK();
+    out->replaying = pt_rp_active;
+    out->frames_replayed = pt_rp_replayed;
+    out->frames_total = pt_rp_frames;
+    out->max_lag_us = pt_rp_max_lag_us;
+    PT_RP_UNLOCK();
+}
+
+#else /* !CONFIG_PT_TOUCH_REPLAY */
+
+esp_err_t pt_touch_record_start(const char *path)
+{
+    (void)path;
+    return ESP_ERR_NOT_SUPPORTED;
+}
+esp_err_t pt_touch_record_stop(void) { return ESP_ERR_NOT_SUPPORTED; }
+void pt_touch_record_frame(const pt_touch_event_t *ev) { (void)ev; }
+esp_err_t pt_touch_replay_start(const char *path, pt_touch_replay_mode_t mode)
+{
+    (void)path;
+    (void)mode;
+    return ESP_ERR_NOT_SUPPORTED;
+}
+esp_err_t pt_touch_replay_start_mem(const void *data, size_t len, pt_touch_replay_mode_t mode)
+{
+    (void)data;
+    (void)len;
+    (void)mode;
+    return ESP_ERR_NOT_SUPPORTED;
+}
+void pt_touch_replay_stop(void) {}
+bool pt_touch_replay_active(void) { return false; }
+bool pt_touch_replay_next(pt_touch_event_t *ev, bool *more)
+{
+    (void)ev;
+    if (more)
+        *more = false;
+    return false;
+}
+void pt_touch_replay_set_notify(pt_touch_event_cb_t cb, void *arg)
+{
+    (void)cb;
+    (void)arg;
+}
+void pt_touch_replay_get_status(pt_touch_replay_status_t *out)
+{
+    if (out)
+        memset(out, 0, sizeof(*out));
+}
+
+#endif